@@ -1,14 +1,48 @@
 #include "gbv.h"
 
+#include <string.h>
+
 #define GBV_VERSION_MAJOR 1
-#define GBV_VERSION_MINOR 3
-#define GBV_VERSION_PATCH 1
+#define GBV_VERSION_MINOR 4
+#define GBV_VERSION_PATCH 0
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GBV_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GBV_TARGET(isa)
+#else
+#include <cpuid.h>
+#define GBV_TARGET(isa) __attribute__((target(isa)))
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#define GBV_X64
+#endif
+#endif
+
+/*
+  instrumentation, compiled in with GBV_STATS defined
+  timers count TSC ticks on x86 and stay 0 elsewhere
+*/
+#ifdef GBV_STATS
+#define GBV_STATS_ADD(state, field, value) ((state)->stats.field += (value))
+#define GBV_STATS_MAX(state, field, value) ((state)->stats.field = GBV_MAX((state)->stats.field, (value)))
+#define GBV_STATS_TIMER(name) unsigned long long name = read_timer()
+#define GBV_STATS_TIME(state, field, name) ((state)->stats.field += read_timer() - (name))
+#else
+#define GBV_STATS_ADD(state, field, value)
+#define GBV_STATS_MAX(state, field, value)
+#define GBV_STATS_TIMER(name)
+#define GBV_STATS_TIME(state, field, name)
+#endif
 
 #define OBJ_NULL 0xff
 #define MAX_OBJECTS_PER_SCANLINE 10
 
-#define GBV_MIN(a, b) ((a) < (b)) ? (a) : (b)
-#define GBV_MAX(a, b) ((a) > (b)) ? (a) : (b)
+#define GBV_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define GBV_MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define GBV_SPRITE_MARGIN_LEFT 8
 #define GBV_SPRITE_MARGIN_TOP 16
 
@@ -23,398 +57,2938 @@ GBV_API gbv_io gbv_io_lyc  = 0;
 GBV_API gbv_io gbv_io_wx   = 0;
 GBV_API gbv_io gbv_io_wy   = 0;
 
-/* internal data pointers */
-static gbv_u8 * gbv_mem;
-static gbv_u8 * gbv_tile_data;
-static gbv_u8 * gbv_tile_map0;
-static gbv_u8 * gbv_tile_map1;
-static gbv_obj_char * gbv_oam_data;
+/* decoded tile cache, one palette index per byte */
+struct tile_cache_data {
+	gbv_u8 raw[GBV_TILE_MEMORY_SIZE];
+	gbv_u8 pixels[GBV_TILE_COUNT * GBV_TILE_PIXELS];
+	gbv_u8 pixels_flipped[GBV_TILE_COUNT * GBV_TILE_PIXELS];
+	gbv_u8 dirty[GBV_TILE_COUNT / 8];
+};
+
+#define BG_LAYER_PITCH (GBV_BG_TILES_X * GBV_TILE_WIDTH)
+
+/*
+  pre-rendered tile maps, one palette index per byte
+  layer 2 * map + data select shows tile map 0 or 1 with unsigned or signed tile ids
+*/
+struct bg_layer_data {
+	gbv_u8 pixels[4][GBV_BG_LAYER_SIZE];
+	gbv_u8 raw[GBV_TILE_MEMORY_SIZE];
+	gbv_u8 maps[2 * GBV_BG_MAP_MEMORY_SIZE];
+	gbv_u8 valid[4];
+};
+
+/* pixel tags of a scanline and the hash of everything they were rendered from */
+struct cached_line {
+	unsigned long long hash;
+	gbv_u32 generation; /* tile data generation the line was rendered with */
+	gbv_u8 valid;
+	gbv_u8 result;      /* line_cache_result of the current frame */
+	gbv_u8 tags[GBV_SCREEN_WIDTH];
+};
+
+enum line_cache_result {
+	LINE_CACHE_NONE,
+	LINE_CACHE_HIT,
+	LINE_CACHE_MISS,
+};
+
+/*
+  scanlines of the previous frame, reused when the inputs of a line hash the same
+  tile data is not hashed, a generation is counted up whenever it changes and kept per tile
+*/
+struct line_cache_data {
+	cached_line lines[GBV_SCREEN_HEIGHT];
+	gbv_u8 raw[GBV_TILE_MEMORY_SIZE];
+	gbv_u32 tile_generation[GBV_TILE_COUNT];
+	gbv_u32 generation;
+	gbv_line_cache_stats stats;
+};
+
+/* selected objects of every scanline, rebuilt when OAM or the object size changes */
+struct oam_index_data {
+	unsigned long long raw[GBV_OBJ_SIZE / 8];
+	gbv_u8 objs[GBV_SCREEN_HEIGHT][MAX_OBJECTS_PER_SCANLINE];
+	gbv_u8 counts[GBV_SCREEN_HEIGHT];
+	gbv_u8 valid;
+	gbv_u8 obj_size;
+};
+
+/* damage tracking: shades of the last tracked frame and the inputs it started from */
+struct damage_data {
+	gbv_u8 shades[GBV_SCREEN_HEIGHT][GBV_SCREEN_WIDTH];
+	gbv_u8 vram[GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE];
+	gbv_obj_char oam[GBV_OBJ_COUNT];
+	gbv_io_regs io;
+	gbv_u8 x_first[GBV_SCREEN_HEIGHT]; /* changed pixels of every line of the last frame */
+	gbv_u8 x_end[GBV_SCREEN_HEIGHT];   /* 0 if the line didn't change */
+	gbv_u8 * buffer;                   /* output the shades were written to */
+	int pitch;
+	gbv_u8 format;
+	gbv_u8 scale;
+	gbv_u8 epx;
+	gbv_u8 colors8[4];
+	gbv_u32 colors32[4];
+	gbv_u8 static_lines; /* lines the last frame rendered before an input changed */
+	gbv_u8 valid;        /* shades hold the output of the last tracked frame */
+	gbv_u8 full;         /* the whole screen is damaged */
+};
+
+/* memory read by the pixel transfer, either the live memory of a context or a band snapshot */
+struct vram_view {
+	gbv_u8 * tile_data;
+	gbv_u8 * tile_map0;
+	gbv_u8 * tile_map1;
+	gbv_obj_char * oam_data;
+	tile_cache_data * tile_cache;
+	bg_layer_data * bg_layers;
+	line_cache_data * line_cache;
+	damage_data * damage; /* set while the damage of the frame is tracked */
+};
+
+/* registers and selected objects seen by the pixel transfer of one scanline */
+struct line_input {
+	gbv_io_regs io;
+	gbv_u8 obj_count;
+	gbv_u8 objs[MAX_OBJECTS_PER_SCANLINE];
+};
+
+enum output_format {
+	OUTPUT_FORMAT_8,
+	OUTPUT_FORMAT_32,
+	OUTPUT_FORMAT_PACKED_2,
+};
+
+/* output format of a frame, resolved once before rendering */
+struct render_output {
+	gbv_u8 * buffer;
+	int pitch;
+	output_format format;
+	gbv_u8 scale;
+	gbv_u8 epx;
+	gbv_line_sink sink;
+	void * sink_user_data;
+	gbv_u8 colors8[16]; /* only the 4 shades are used, padded for remap_bytes */
+	gbv_u32 colors32[4];
+};
 
-static gbv_int_callback gbv_lcdc_int_callback;
-static gbv_io gbv_io_stat;
-static gbv_io gbv_io_ly;
+/*
+  shades of the consecutive scanlines written by the serial path
+  the last shades are kept for epx output, which lags one line behind
+*/
+struct line_emitter {
+	gbv_u8 shades[3][GBV_SCREEN_WIDTH];
+};
+
+/* position of the dot clock driven by gbv_step */
+struct step_state {
+	gbv_u16 dot;
+	gbv_u8 ly;
+	gbv_u8 event;
+};
+
+/* frame in progress, between gbv_begin_frame and gbv_end_frame */
+struct frame_state {
+	render_output output;
+	line_emitter emitter;
+	line_input input;
+	gbv_u8 active;
+	gbv_u8 pixels; /* 0 for frames without a target buffer, only LY, STAT and interrupts advance */
+	gbv_u8 bands;  /* lines are recorded for band rendering */
+	gbv_u8 next_line;
+	gbv_u8 first_pending;
+	gbv_u8 recorded_end;    /* lines before it are recorded for band rendering */
+	gbv_u8 external_writes; /* the caller ran since the last line and may have written to video memory */
+	gbv_u8 damage;       /* damage of the frame is tracked */
+	gbv_u8 unchanged;    /* no input changed since the frame started */
+	gbv_u8 skip_lines;   /* lines up to which the output of the previous frame is kept while unchanged */
+	gbv_u32 write_serial;
+};
+
+/* band rendering: video memory snapshot and the recorded scanlines that are not rendered yet */
+struct band_memory {
+	gbv_u8 vram[GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE];
+	gbv_obj_char oam[GBV_OBJ_COUNT];
+	line_input lines[GBV_SCREEN_HEIGHT];
+	gbv_u8 shades[GBV_SCREEN_HEIGHT][GBV_SCREEN_WIDTH];
+};
+
+static_assert(sizeof(bg_layer_data) <= GBV_BG_LAYER_CACHE_SIZE, "GBV_BG_LAYER_CACHE_SIZE is too small");
+static_assert(sizeof(line_cache_data) <= GBV_LINE_CACHE_SIZE, "GBV_LINE_CACHE_SIZE is too small");
+static_assert(sizeof(band_memory) <= GBV_BAND_MEMORY_SIZE, "GBV_BAND_MEMORY_SIZE is too small");
+static_assert(sizeof(damage_data) <= GBV_DAMAGE_MEMORY_SIZE, "GBV_DAMAGE_MEMORY_SIZE is too small");
 
 /* internal tracking of triggerable interrupts during LCD operation */
-static struct lcd_stat_trig {
+/* trace records, see gbv.h for the format */
+enum trace_record {
+	TRACE_RECORD_FRAME    = 0x01,
+	TRACE_RECORD_CALLBACK = 0x02,
+	TRACE_RECORD_REG      = 0x03,
+	TRACE_RECORD_STAT     = 0x04,
+	TRACE_RECORD_MEM      = 0x05,
+};
+
+#define TRACE_VRAM_START  0x8000
+#define TRACE_VRAM_SIZE   (GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE)
+#define TRACE_OAM_START   0xFE00
+#define TRACE_BUFFER_SIZE 4096
+#define TRACE_VERSION     1
+
+/* shadow copy of the traced state and the pending output, provided by the caller */
+struct trace_memory {
+	gbv_u8 vram[TRACE_VRAM_SIZE];
+	gbv_u8 oam[GBV_OAM_MEMORY_SIZE];
+	gbv_io_regs io;
+	gbv_u8 stat;
+	gbv_u8 full; /* the next delta writes everything */
+	gbv_u16 used;
+	gbv_u8 buffer[TRACE_BUFFER_SIZE];
+};
+static_assert(sizeof(trace_memory) <= GBV_TRACE_MEMORY_SIZE, "GBV_TRACE_MEMORY_SIZE is too small");
+
+struct lcd_stat_trig {
 	gbv_u8 ints[4];
-} global_lcd_stat_trig;
+};
 
-/* internal functions */
-static gbv_u8 get_color(gbv_u8 idx, gbv_u8 pal) {
-	gbv_u8 color = (pal >> (2 * idx)) & 0x03;
-	return color;
+/* internal state of a context, lives in gbv_context::state */
+struct gbv_state {
+	/* internal data pointers */
+	gbv_u8 * mem;
+	gbv_u8 * tile_data;
+	gbv_u8 * tile_map0;
+	gbv_u8 * tile_map1;
+	gbv_obj_char * oam_data;
+
+	gbv_ctx_int_callback lcdc_int_callback;
+	void * lcdc_int_user_data;
+	gbv_io io_stat;
+	gbv_io io_ly;
+
+	tile_cache_data * tile_cache;
+	bg_layer_data * bg_layers;
+	line_cache_data * line_cache;
+	gbv_u8 caches_stale; /* video memory may have changed since the caches were synced */
+
+	oam_index_data oam_index;
+	gbv_u8 oam_index_stale; /* OAM may have been written since it was compared against the index */
+
+	lcd_stat_trig stat_trig;
+
+	band_memory * bands;
+	gbv_u8 band_count;
+	gbv_parallel_for parallel_for;
+	void * parallel_for_user_data;
+
+	gbv_line_sink line_sink;
+	void * line_sink_user_data;
+
+	gbv_u8 * retained;
+	gbv_u8 retained_valid;
+
+	gbv_dirty_regions dirty;
+	gbv_u32 write_serial; /* counted up by every tracked write to video memory */
+
+	damage_data * damage;
+
+	trace_memory * trace;
+	gbv_trace_write trace_write;
+	void * trace_user_data;
+
+	frame_state frame;
+	step_state step;
+	int render_every_count;
+
+#ifdef GBV_STATS
+	gbv_stats stats;
+#endif
+};
+
+static_assert(sizeof(gbv_state) <= GBV_CONTEXT_STATE_SIZE, "GBV_CONTEXT_STATE_SIZE is too small");
+
+static gbv_state * get_state(gbv_context * ctx) {
+	return (gbv_state*)ctx->state.data;
 }
 
-static gbv_u8 get_pal_idx_from_tile_row(gbv_u8 row[2], gbv_u8 x) {
-	gbv_u8 pal_idx = ((row[0] >> (7 - x)) & 0x01) | ((row[1] >> (7 - x) & 0x01) << 1);
-	return pal_idx;
+/* context behind the global API, its registers are mirrored in the gbv_io_* globals */
+static gbv_context global_ctx;
+static gbv_int_callback global_int_callback;
+
+/* internal functions */
+#ifdef GBV_STATS
+static unsigned long long read_timer() {
+#ifdef GBV_X86
+	return __rdtsc();
+#else
+	return 0;
+#endif
 }
+#endif
 
-static gbv_u8 get_pixel_from_tile_row(gbv_u8 row[2], gbv_u8 x, gbv_u8 pal) {
-	gbv_u8 pal_idx = get_pal_idx_from_tile_row(row, x);
-	gbv_u8 color = get_color(pal_idx, pal);
+static gbv_u8 get_color(gbv_u8 idx, gbv_u8 pal) {
+	gbv_u8 color = (pal >> (2 * idx)) & 0x03;
 	return color;
 }
 
+/* buffer may start at any byte, the words are stored through memcpy */
 static void fill_memory(void * buffer, gbv_u16 size, gbv_u8 value) {
 	gbv_u16 size8 = size / 8;
 	gbv_u16 rem = size % 8;
-	unsigned long long * buffer8 = (unsigned long long*)buffer;
-	if (size8) {
-		unsigned long long value8 = (unsigned long long)value;
-		value8 |= (value8 << 56) | (value8 << 48) | (value8 << 40) | (value8 << 32) | (value8 << 24) | (value8 << 16) | (value8 << 8);
-		for (gbv_u16 i = 0; i < size8; i++) {
-			buffer8[i] = value8;
-		}
+	gbv_u8 * bytes = (gbv_u8*)buffer;
+	unsigned long long value8 = 0x0101010101010101ULL * value;
+	for (gbv_u16 i = 0; i < size8; i++) {
+		memcpy(bytes + 8 * i, &value8, 8);
 	}
-	if (rem) {
-		gbv_u8 * buffer_rem = (gbv_u8*)(buffer8 + size8);
-		for (gbv_u8 i = 0; i < rem; i++) {
-			buffer_rem[i] = value;
-		}
+	gbv_u8 * buffer_rem = bytes + 8 * size8;
+	for (gbv_u8 i = 0; i < rem; i++) {
+		buffer_rem[i] = value;
 	}
 }
 
-gbv_u8 * get_tile_from_tilemap(gbv_u8 x, gbv_u8 y, gbv_lcdc_flag map_select) {
-	gbv_u8 *tile_map = (gbv_io_lcdc & map_select) ? gbv_tile_map1 : gbv_tile_map0;
-	gbv_u8 tile_id = tile_map[GBV_BG_TILES_X * y + x];
+/* set the bits of value in every byte of buffer */
+static void or_memory(void * buffer, gbv_u16 size, gbv_u8 value) {
+	gbv_u16 size8 = size / 8;
+	gbv_u16 rem = size % 8;
+	gbv_u8 * bytes = (gbv_u8*)buffer;
+	unsigned long long value8 = 0x0101010101010101ULL * value;
+	for (gbv_u16 i = 0; i < size8; i++) {
+		unsigned long long chunk;
+		memcpy(&chunk, bytes + 8 * i, 8);
+		chunk |= value8;
+		memcpy(bytes + 8 * i, &chunk, 8);
+	}
+	gbv_u8 * buffer_rem = bytes + 8 * size8;
+	for (gbv_u8 i = 0; i < rem; i++) {
+		buffer_rem[i] |= value;
+	}
+}
 
-	tile_id = (gbv_io_lcdc & GBV_LCDC_BG_DATA_SELECT) ? (~tile_id + 1) : tile_id;
+/* reverse the byte order of 8 palette indices */
+static unsigned long long flip_row(unsigned long long row) {
+	row = ((row & 0x00FF00FF00FF00FFULL) << 8) | ((row >> 8) & 0x00FF00FF00FF00FFULL);
+	row = ((row & 0x0000FFFF0000FFFFULL) << 16) | ((row >> 16) & 0x0000FFFF0000FFFFULL);
+	return (row << 32) | (row >> 32);
+}
 
-	gbv_u8 * tile_data = (gbv_io_lcdc & GBV_LCDC_BG_DATA_SELECT) ? gbv_tile_data + 0x800 : gbv_tile_data;
-	gbv_u8 * tile = tile_data + GBV_TILE_SIZE * tile_id;
+/*
+  tile row decoders: count rows of 2 bitplane bytes each are turned into 8 palette indices per row
+  all kernels store indices as little endian 64 bit words
+*/
+typedef void (*decode_rows_func)(const gbv_u8 * rows, gbv_u16 count, gbv_u8 * out);
 
-	return tile;
+/* moves bit 7 - i of b into byte i, the shifted copies of b never overlap so there are no carries */
+static unsigned long long spread_bits(gbv_u8 b) {
+	return ((b * 0x8040201008040201ULL) & 0x8080808080808080ULL) >> 7;
 }
 
-void check_for_lcd_interrupts() {
-	if (gbv_lcdc_int_callback) {
-		gbv_lcd_mode mode = gbv_stat_mode();
-		if (global_lcd_stat_trig.ints[mode]) {
-			gbv_u8 trigger = 0;
-			switch (mode) {
-			case GBV_LCD_MODE_HBLANK:
-				trigger = gbv_io_stat & GBV_STAT_HBLANK_INT;
-				break;
-			case GBV_LCD_MODE_VBLANK:
-				trigger = gbv_io_stat & GBV_STAT_VBLANK_INT;
-				break;
-			case GBV_LCD_MODE_OAM:
-				trigger = gbv_io_stat & GBV_STAT_OAM_INT;
-				break;
-			case GBV_LCD_MODE_TRANSFER:
-				trigger = (gbv_io_stat & GBV_STAT_LYC_INT) && (gbv_io_stat & GBV_STAT_LYC);
-				break;
-			}
-			if (trigger) {
-				global_lcd_stat_trig.ints[mode] = 0;
-				gbv_lcdc_int_callback();
-			}
-		}
+static void decode_rows_scalar(const gbv_u8 * rows, gbv_u16 count, gbv_u8 * out) {
+	unsigned long long * out8 = (unsigned long long*)out;
+	for (gbv_u16 i = 0; i < count; i++) {
+		out8[i] = spread_bits(rows[2 * i]) | (spread_bits(rows[2 * i + 1]) << 1);
 	}
 }
 
-void lcd_change_mode(gbv_lcd_mode mode) {
-	gbv_io_stat = (gbv_io_stat & ~GBV_STAT_MODE) | (mode & GBV_STAT_MODE);
-	global_lcd_stat_trig.ints[mode] = true;
-	check_for_lcd_interrupts();
+#ifdef GBV_X86
+/* two rows per iteration: broadcast each bitplane byte, then test one bit per lane */
+GBV_TARGET("sse2") static void decode_rows_sse2(const gbv_u8 * rows, gbv_u16 count, gbv_u8 * out) {
+	const __m128i mask = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i two = _mm_set1_epi8(2);
+	gbv_u16 i = 0;
+	for (; i + 2 <= count; i += 2) {
+		int planes;
+		memcpy(&planes, rows + 2 * i, sizeof(planes));
+		__m128i v = _mm_cvtsi32_si128(planes);
+		v = _mm_unpacklo_epi8(v, v);
+		v = _mm_unpacklo_epi16(v, v);
+		__m128i row0 = _mm_unpacklo_epi32(v, v);
+		__m128i row1 = _mm_unpackhi_epi32(v, v);
+		__m128i lo = _mm_unpacklo_epi64(row0, row1);
+		__m128i hi = _mm_unpackhi_epi64(row0, row1);
+		lo = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo, mask), mask), one);
+		hi = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi, mask), mask), two);
+		_mm_storeu_si128((__m128i*)(out + GBV_TILE_WIDTH * i), _mm_or_si128(lo, hi));
+	}
+	if (i < count) {
+		decode_rows_scalar(rows + 2 * i, count - i, out + GBV_TILE_WIDTH * i);
+	}
 }
+#endif
 
-/* API functions */
-void gbv_get_version(int * maj, int * min, int * patch) {
-	if (maj) {
-		*maj = GBV_VERSION_MAJOR;
+#ifdef GBV_X64
+/* pdep deposits bit i into byte i, which is the reverse of the pixel order */
+GBV_TARGET("bmi2") static void decode_rows_bmi2(const gbv_u8 * rows, gbv_u16 count, gbv_u8 * out) {
+	unsigned long long * out8 = (unsigned long long*)out;
+	for (gbv_u16 i = 0; i < count; i++) {
+		unsigned long long lo = _pdep_u64(rows[2 * i], 0x0101010101010101ULL);
+		unsigned long long hi = _pdep_u64(rows[2 * i + 1], 0x0202020202020202ULL);
+		out8[i] = flip_row(lo | hi);
 	}
-	if (min) {
-		*min = GBV_VERSION_MINOR;
+}
+#endif
+
+static int cpu_supports(gbv_decode_kernel kernel) {
+	switch (kernel) {
+	case GBV_DECODE_KERNEL_SCALAR:
+		return 1;
+#ifdef GBV_X86
+	case GBV_DECODE_KERNEL_SSE2: {
+#if defined(_MSC_VER)
+		int regs[4];
+		__cpuid(regs, 1);
+		return (regs[3] >> 26) & 1;
+#else
+		unsigned int eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && ((edx >> 26) & 1);
+#endif
 	}
-	if (patch) {
-		*patch = GBV_VERSION_PATCH;
+#endif
+#ifdef GBV_X64
+	case GBV_DECODE_KERNEL_BMI2: {
+#if defined(_MSC_VER)
+		int regs[4];
+		__cpuidex(regs, 7, 0);
+		return (regs[1] >> 8) & 1;
+#else
+		unsigned int eax, ebx, ecx, edx;
+		return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && ((ebx >> 8) & 1);
+#endif
+	}
+#endif
+	default:
+		return 0;
 	}
 }
 
-void gbv_init(void * memory) {
-	gbv_mem       = (gbv_u8*)memory;
-	gbv_tile_data = gbv_mem + 0x8000;
-	gbv_tile_map0 = gbv_mem + 0x9800;
-	gbv_tile_map1 = gbv_mem + 0x9C00;
-	gbv_oam_data  = (gbv_obj_char*)(gbv_mem + 0xFE00);
+/* pick the decoder for a kernel, 0 if the cpu doesn't support it */
+static decode_rows_func find_decode_kernel(gbv_decode_kernel kernel) {
+	if (kernel == GBV_DECODE_KERNEL_AUTO) {
+		kernel = cpu_supports(GBV_DECODE_KERNEL_SSE2) ? GBV_DECODE_KERNEL_SSE2 : GBV_DECODE_KERNEL_SCALAR;
+	}
+	if (!cpu_supports(kernel)) {
+		return 0;
+	}
+	switch (kernel) {
+#ifdef GBV_X86
+	case GBV_DECODE_KERNEL_SSE2:
+		return decode_rows_sse2;
+#endif
+#ifdef GBV_X64
+	case GBV_DECODE_KERNEL_BMI2:
+		return decode_rows_bmi2;
+#endif
+	default:
+		return decode_rows_scalar;
+	}
 }
 
-void gbv_lcdc_set(gbv_lcdc_flag flag) {
-	gbv_io_lcdc = gbv_io_lcdc | flag;
-}
+/* shared by all contexts, selected once at startup */
+static decode_rows_func decode_rows = find_decode_kernel(GBV_DECODE_KERNEL_AUTO);
 
-void gbv_lcdc_reset(gbv_lcdc_flag flag) {
-	gbv_io_lcdc = gbv_io_lcdc & ~flag;
-}
+/* byte remap through a 16 entry table, all source values are below 16 */
+typedef void (*remap_bytes_func)(const gbv_u8 * table, const gbv_u8 * src, gbv_u8 * dst, gbv_u16 count);
 
-void gbv_stat_set(gbv_stat_flag flag) {
-	if (flag > GBV_STAT_LYC) {
-		gbv_io_stat = gbv_io_stat | flag;
+static void remap_bytes_scalar(const gbv_u8 * table, const gbv_u8 * src, gbv_u8 * dst, gbv_u16 count) {
+	for (gbv_u16 i = 0; i < count; i++) {
+		dst[i] = table[src[i]];
 	}
 }
 
-void gbv_stat_reset(gbv_stat_flag flag) {
-	if (flag > GBV_STAT_LYC) {
-		gbv_io_stat = gbv_io_stat & ~flag;
+#ifdef GBV_X86
+/* the table fits one register, pshufb looks up 16 bytes at once */
+GBV_TARGET("ssse3") static void remap_bytes_ssse3(const gbv_u8 * table, const gbv_u8 * src, gbv_u8 * dst, gbv_u16 count) {
+	const __m128i lut = _mm_loadu_si128((const __m128i*)table);
+	gbv_u16 i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(lut, v));
+	}
+	if (i < count) {
+		remap_bytes_scalar(table, src + i, dst + i, count - i);
 	}
 }
+#endif
 
-gbv_lcd_mode gbv_stat_mode() {
-	return (gbv_lcd_mode)(gbv_io_stat & GBV_STAT_MODE);
+static remap_bytes_func find_remap_kernel() {
+#ifdef GBV_X86
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuid(regs, 1);
+	if ((regs[2] >> 9) & 1) {
+		return remap_bytes_ssse3;
+	}
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && ((ecx >> 9) & 1)) {
+		return remap_bytes_ssse3;
+	}
+#endif
+#endif
+	return remap_bytes_scalar;
 }
 
-gbv_u8 gbv_stat_lyc() {
-	return gbv_io_stat & GBV_STAT_LYC;
-}
+static remap_bytes_func remap_bytes = find_remap_kernel();
 
-gbv_io gbv_ly() {
-	return gbv_io_ly;
+/* set bits [first, end) of a bitmap */
+static void set_bits(gbv_u8 * bits, int first, int end) {
+	for (int i = first; i < end; i++) {
+		bits[i / 8] |= 1 << (i % 8);
+	}
 }
 
-gbv_u8 * gbv_get_rom_data() {
-	return gbv_mem;
+/* mark the units of size bytes in [start, start + count) overlapped by a write to [address, address + length) */
+static void mark_dirty_units(gbv_u8 * bits, int address, int length, int start, int size, int count) {
+	int first = GBV_MAX(address, start) - start;
+	int end = GBV_MIN(address + length, start + size * count) - start;
+	if (first < end) {
+		set_bits(bits, first / size, (end + size - 1) / size);
+	}
 }
 
-gbv_u8 * gbv_get_tile_map0() {
-	return gbv_tile_map0;
+static void mark_dirty(gbv_state * state, int address, int length) {
+	gbv_dirty_regions * dirty = &state->dirty;
+	state->write_serial++;
+	mark_dirty_units(dirty->tiles, address, length, 0x8000, GBV_TILE_SIZE, GBV_TILE_COUNT);
+	mark_dirty_units(dirty->map_rows, address, length, 0x9800, GBV_BG_TILES_X, 2 * GBV_BG_TILES_Y);
+	mark_dirty_units(dirty->oam, address, length, 0xFE00, sizeof(gbv_obj_char), GBV_OBJ_COUNT);
 }
 
-gbv_u8 * gbv_get_tile_map1() {
-	return gbv_tile_map1;
-}
+/* compare tile data against the shadow copy and decode all tiles that changed */
+static void sync_tile_cache(gbv_state * state) {
+	tile_cache_data * cache = state->tile_cache;
+	unsigned long long * src = (unsigned long long*)state->tile_data;
+	unsigned long long * shadow = (unsigned long long*)cache->raw;
+	for (gbv_u16 tile = 0; tile < GBV_TILE_COUNT; tile++) {
+		if (src[2 * tile] != shadow[2 * tile] || src[2 * tile + 1] != shadow[2 * tile + 1]) {
+			cache->dirty[tile / 8] |= 1 << (tile % 8);
+		}
+	}
+	for (gbv_u16 i = 0; i < GBV_TILE_COUNT / 8; i++) {
+		while (cache->dirty[i]) {
+			gbv_u8 bit = 0;
+			while (!(cache->dirty[i] & (1 << bit))) {
+				bit++;
+			}
+			cache->dirty[i] &= ~(1 << bit);
 
-gbv_u8 * gbv_get_tile_data() {
-	return gbv_tile_data;
+			gbv_u16 tile = 8 * i + bit;
+			shadow[2 * tile] = src[2 * tile];
+			shadow[2 * tile + 1] = src[2 * tile + 1];
+			unsigned long long * pixels = (unsigned long long*)(cache->pixels + GBV_TILE_PIXELS * tile);
+			unsigned long long * pixels_flipped = (unsigned long long*)(cache->pixels_flipped + GBV_TILE_PIXELS * tile);
+			decode_rows(cache->raw + GBV_TILE_SIZE * tile, GBV_TILE_HEIGHT, (gbv_u8*)pixels);
+			for (gbv_u8 y = 0; y < GBV_TILE_HEIGHT; y++) {
+				pixels_flipped[y] = flip_row(pixels[y]);
+			}
+		}
+	}
 }
 
-gbv_tile * gbv_get_tile(gbv_u8 tile_id) {
-	return (gbv_tile*)gbv_tile_data + tile_id;
+/* tile index of a tile map entry, counted from the start of tile data */
+static gbv_u16 get_map_tile_index(gbv_u8 tile_id, gbv_u8 signed_ids) {
+	return signed_ids ? 0x800 / GBV_TILE_SIZE + (gbv_u8)(~tile_id + 1) : tile_id;
 }
 
-void gbv_lcdc_set_stat_interrupt(gbv_int_callback callback) {
-	gbv_lcdc_int_callback = callback;
+/* decode the tile of map cell (x, y) into a bg layer, from the shadow copy of tile data */
+static void draw_bg_layer_cell(bg_layer_data * layers, gbv_u8 layer, gbv_u8 x, gbv_u8 y, gbv_u16 tile) {
+	unsigned long long rows[GBV_TILE_HEIGHT];
+	decode_rows(layers->raw + GBV_TILE_SIZE * tile, GBV_TILE_HEIGHT, (gbv_u8*)rows);
+	gbv_u8 * dst = layers->pixels[layer] + BG_LAYER_PITCH * GBV_TILE_HEIGHT * y + GBV_TILE_WIDTH * x;
+	for (gbv_u8 row = 0; row < GBV_TILE_HEIGHT; row++) {
+		*(unsigned long long*)(dst + BG_LAYER_PITCH * row) = rows[row];
+	}
 }
 
-void gbv_transfer_oam_data(gbv_obj_char objs[GBV_OBJ_COUNT]) {
-	for (int i = 0; i < GBV_OBJ_COUNT; i++) {
-		gbv_oam_data[i] = objs[i];
+static void build_bg_layer(bg_layer_data * layers, gbv_u8 layer) {
+	const gbv_u8 * map = layers->maps + GBV_BG_MAP_MEMORY_SIZE * (layer / 2);
+	for (gbv_u8 y = 0; y < GBV_BG_TILES_Y; y++) {
+		for (gbv_u8 x = 0; x < GBV_BG_TILES_X; x++) {
+			draw_bg_layer_cell(layers, layer, x, y, get_map_tile_index(map[GBV_BG_TILES_X * y + x], layer & 1));
+		}
 	}
+	layers->valid[layer] = 1;
 }
 
-#if 1
-void gbv_render(void * render_buffer, gbv_render_mode mode, gbv_palette * palette) {
-	gbv_u8 * buffer = (gbv_u8*)render_buffer;
-	global_lcd_stat_trig = {};
-	if (gbv_io_lcdc & GBV_LCDC_CTRL) {
-		for (gbv_u8 lcd_y = 0; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
-			gbv_io_ly = lcd_y;
-			if (gbv_io_lyc == gbv_io_ly) {
-				gbv_io_stat = gbv_io_stat | GBV_STAT_LYC;
-			}
-			else {
-				gbv_io_stat = (gbv_io_stat & ~GBV_STAT_LYC);
-			}
-
-			lcd_change_mode(GBV_LCD_MODE_OAM);
-			gbv_u8 obj_count = 0;
-			gbv_u8 objs[MAX_OBJECTS_PER_SCANLINE];
-			if (gbv_io_lcdc & GBV_LCDC_OBJ_SIZE_SELECT) {
-				// TODO: figure out if sprite attributes from obj[0] or obj[1] is used in case of hit on obj[1]
-				for (gbv_u8 idx = 0; idx < (GBV_OBJ_COUNT >> 1); idx++) {
-					gbv_obj_char* obj = gbv_oam_data + 2 * idx;
-					if (obj->y <= lcd_y + GBV_SPRITE_MARGIN_TOP && obj->y + 2 * GBV_TILE_HEIGHT > lcd_y + GBV_SPRITE_MARGIN_TOP) {
-						if (obj_count < MAX_OBJECTS_PER_SCANLINE) {
-							objs[obj_count++] = (lcd_y - obj->y < GBV_TILE_HEIGHT) ? 2 * idx : 2 * idx + 1;
-						}
-					}
-				}
+/*
+  compare tile data and tile maps of view against the shadow copies
+  map cells of valid layers are drawn again when their tile id or the data of their tile changed
+*/
+static void sync_bg_layers(gbv_state * state, const vram_view * view) {
+	bg_layer_data * layers = state->bg_layers;
+	gbv_u8 changed[GBV_TILE_COUNT / 8] = {};
+	gbv_u8 tiles_changed = 0;
+	unsigned long long * src = (unsigned long long*)view->tile_data;
+	unsigned long long * shadow = (unsigned long long*)layers->raw;
+	for (gbv_u16 tile = 0; tile < GBV_TILE_COUNT; tile++) {
+		if (src[2 * tile] != shadow[2 * tile] || src[2 * tile + 1] != shadow[2 * tile + 1]) {
+			shadow[2 * tile] = src[2 * tile];
+			shadow[2 * tile + 1] = src[2 * tile + 1];
+			changed[tile / 8] |= 1 << (tile % 8);
+			tiles_changed = 1;
+		}
+	}
+	for (gbv_u8 m = 0; m < 2; m++) {
+		const gbv_u8 * map = m ? view->tile_map1 : view->tile_map0;
+		gbv_u8 * map_shadow = layers->maps + GBV_BG_MAP_MEMORY_SIZE * m;
+		for (gbv_u8 y = 0; y < GBV_BG_TILES_Y; y++) {
+			const unsigned long long * row = (const unsigned long long*)(map + GBV_BG_TILES_X * y);
+			unsigned long long * row_shadow = (unsigned long long*)(map_shadow + GBV_BG_TILES_X * y);
+			if (!tiles_changed && row[0] == row_shadow[0] && row[1] == row_shadow[1] && row[2] == row_shadow[2] && row[3] == row_shadow[3]) {
+				continue;
 			}
-			else {
-				for (gbv_u8 idx = 0; idx < GBV_OBJ_COUNT; idx++) {
-					gbv_obj_char* obj = gbv_oam_data + idx;
-					if (obj->y <= lcd_y + GBV_SPRITE_MARGIN_TOP && obj->y + GBV_TILE_HEIGHT > lcd_y + GBV_SPRITE_MARGIN_TOP) {
-						if (obj_count < MAX_OBJECTS_PER_SCANLINE) {
-							objs[obj_count++] = idx;
-						}
+			for (gbv_u8 x = 0; x < GBV_BG_TILES_X; x++) {
+				gbv_u8 tile_id = map[GBV_BG_TILES_X * y + x];
+				gbv_u8 id_changed = tile_id != map_shadow[GBV_BG_TILES_X * y + x];
+				map_shadow[GBV_BG_TILES_X * y + x] = tile_id;
+				for (gbv_u8 signed_ids = 0; signed_ids < 2; signed_ids++) {
+					gbv_u8 layer = 2 * m + signed_ids;
+					gbv_u16 tile = get_map_tile_index(tile_id, signed_ids);
+					if (layers->valid[layer] && (id_changed || (changed[tile / 8] & (1 << (tile % 8))))) {
+						draw_bg_layer_cell(layers, layer, x, y, tile);
 					}
 				}
 			}
+		}
+	}
+}
 
-			lcd_change_mode(GBV_LCD_MODE_TRANSFER);
-			for (gbv_u8 lcd_x = 0; lcd_x < GBV_SCREEN_WIDTH; lcd_x++) {
-				gbv_u8 pal_idx = 0;
-				gbv_u8 pal = 0;
-				if (gbv_io_lcdc & GBV_LCDC_WND_ENABLE && lcd_x >= gbv_io_wx - 7 && lcd_y >= gbv_io_wy) {
-					gbv_u8 win_x = lcd_x + 7 - gbv_io_wx;
-					gbv_u8 win_y = lcd_y - gbv_io_wy;
-					gbv_u8 tx = win_x / GBV_TILE_WIDTH;
-					gbv_u8 ty = win_y / GBV_TILE_HEIGHT;
-					gbv_u8 px = win_x % GBV_TILE_WIDTH;
-					gbv_u8 py = win_y % GBV_TILE_HEIGHT;
-					gbv_u8* tile = get_tile_from_tilemap(tx, ty, GBV_LCDC_WND_MAP_SELECT);
-					gbv_u8* row = tile + GBV_TILE_PITCH * py;
-					pal_idx = get_pal_idx_from_tile_row(row, px);
-					pal = gbv_io_bgp;
-				}
-				else if (gbv_io_lcdc & GBV_LCDC_BG_ENABLE) {
-					/* map lcd screen position to tilemap position */
-					gbv_u8 bg_x = lcd_x + gbv_io_scx;
-					gbv_u8 bg_y = lcd_y + gbv_io_scy;
-					gbv_u8 tx = bg_x / GBV_TILE_WIDTH;
-					gbv_u8 ty = bg_y / GBV_TILE_HEIGHT;
-					gbv_u8 px = bg_x % GBV_TILE_WIDTH;
-					gbv_u8 py = bg_y % GBV_TILE_HEIGHT;
-					gbv_u8* tile = get_tile_from_tilemap(tx, ty, GBV_LCDC_BG_MAP_SELECT);
-					gbv_u8* row = tile + GBV_TILE_PITCH * py;
-					pal_idx = get_pal_idx_from_tile_row(row, px);
-					pal = gbv_io_bgp;
-				}
-				if (gbv_io_lcdc & GBV_LCDC_OBJ_ENABLE) {
-					// TODO: properly support order of sprites with coinciding x values
-					for (gbv_u8 idx = 0; idx < obj_count; idx++) {
-						gbv_obj_char *obj = gbv_oam_data + objs[obj_count - idx - 1];
-						if (obj->x <= lcd_x + GBV_SPRITE_MARGIN_LEFT && obj->x + 8 > lcd_x + GBV_SPRITE_MARGIN_LEFT) {
-							gbv_u8 px = lcd_x + GBV_SPRITE_MARGIN_LEFT - obj->x;
-							gbv_u8 py = lcd_y + GBV_SPRITE_MARGIN_TOP - obj->y;
-							if (obj->attr & GBV_OBJ_ATTR_FLIP_VERTICAL) {
-								px = GBV_TILE_WIDTH - 1 - px;
-							}
-							if (obj->attr & GBV_OBJ_ATTR_FLIP_HORIZONTAL) {
-								py = GBV_TILE_HEIGHT - 1 - py;
-							}
-							gbv_u8 *tile = gbv_tile_data + GBV_TILE_SIZE * obj->id;
-							gbv_u8 *row = tile + GBV_TILE_PITCH * py;
-							gbv_u8 new_pal_idx = get_pal_idx_from_tile_row(row, px);
-							if ((obj->attr & GBV_OBJ_ATTR_PRIORITY_FLAG) == 0 || (!pal_idx && (obj->attr & GBV_OBJ_ATTR_PRIORITY_FLAG))) {
-								if (new_pal_idx) {
-									pal = (obj->attr & GBV_OBJ_ATTR_PALETTE_SELECT) ? gbv_io_obp1 : gbv_io_obp0;
-									pal_idx = new_pal_idx;
-								}
-							}
-						}
-					}
-				}
-				gbv_u16 index = lcd_y * GBV_SCREEN_WIDTH + lcd_x;
-				buffer[index] = palette->colors[get_color(pal_idx, pal)];
+/* count up the generation of tiles that changed since the last sync */
+static void sync_line_cache(gbv_state * state, const vram_view * view) {
+	line_cache_data * cache = state->line_cache;
+	unsigned long long * src = (unsigned long long*)view->tile_data;
+	unsigned long long * shadow = (unsigned long long*)cache->raw;
+	gbv_u8 counted = 0;
+	for (gbv_u16 tile = 0; tile < GBV_TILE_COUNT; tile++) {
+		if (src[2 * tile] != shadow[2 * tile] || src[2 * tile + 1] != shadow[2 * tile + 1]) {
+			shadow[2 * tile] = src[2 * tile];
+			shadow[2 * tile + 1] = src[2 * tile + 1];
+			if (!counted) {
+				cache->generation++;
+				counted = 1;
 			}
-			lcd_change_mode(GBV_LCD_MODE_HBLANK);
+			cache->tile_generation[tile] = cache->generation;
 		}
-		lcd_change_mode(GBV_LCD_MODE_VBLANK);
 	}
 }
 
-#else
-// old shitty renderer
-void gbv_render(void * render_buffer, gbv_render_mode mode, gbv_palette * palette) {
-	gbv_u8 * buffer = (gbv_u8*)render_buffer;
-	if (gbv_io_lcdc & GBV_LCDC_CTRL) {
-		if (gbv_io_lcdc & GBV_LCDC_BG_ENABLE) {
-			for (gbv_u8 ty = 0; ty < GBV_BG_TILES_Y; ty++) {
-				for (gbv_u8 tx = 0; tx < GBV_BG_TILES_X; tx++) {
-					gbv_u8 * tile = get_tile_from_tilemap(tx, ty, GBV_LCDC_BG_MAP_SELECT);
-					for (gbv_u8 y = 0; y < GBV_TILE_HEIGHT; y++) {
-						gbv_u8 * row = tile + GBV_TILE_PITCH * y;
-						for (gbv_u8 x = 0; x < GBV_TILE_WIDTH; x++) {
-							gbv_u8 dest_x = (GBV_TILE_WIDTH * tx + x) - gbv_io_scx;
-							gbv_u8 dest_y = (GBV_TILE_HEIGHT * ty + y) - gbv_io_scy;
-							/* clipping */
-							if (dest_x < GBV_SCREEN_WIDTH && dest_y < GBV_SCREEN_HEIGHT) {
-								gbv_u8 color = get_pixel_from_tile_row(row, x, gbv_io_bgp);
-								gbv_u16 index = dest_y * GBV_SCREEN_WIDTH + dest_x;
-								buffer[index] = palette->colors[color];
-							}
-						}
-					}
-				}
+/* hit and miss counters of the frame that just ended */
+static void count_line_cache_results(line_cache_data * cache) {
+	gbv_line_cache_stats * stats = &cache->stats;
+	stats->hits = 0;
+	stats->misses = 0;
+	for (gbv_u8 i = 0; i < GBV_SCREEN_HEIGHT; i++) {
+		stats->hits += cache->lines[i].result == LINE_CACHE_HIT;
+		stats->misses += cache->lines[i].result == LINE_CACHE_MISS;
+	}
+	stats->total_hits += stats->hits;
+	stats->total_misses += stats->misses;
+}
+
+/* bring all enabled caches up to date with the video memory of view */
+static void sync_caches(gbv_state * state, const vram_view * view) {
+	if (state->tile_cache) {
+		sync_tile_cache(state);
+	}
+	if (state->bg_layers) {
+		sync_bg_layers(state, view);
+	}
+	if (state->line_cache) {
+		sync_line_cache(state, view);
+	}
+	state->caches_stale = 0;
+}
+
+/*
+  return the 8 palette indices of a tile row, counted in rows from the start of tile data
+  rows are decoded into tmp when the tile cache is disabled
+*/
+static gbv_u8 * get_tile_row_indices(const vram_view * vram, gbv_u16 row_index, gbv_u8 flip, unsigned long long * tmp) {
+	if (vram->tile_cache) {
+		gbv_u8 * pixels = flip ? vram->tile_cache->pixels_flipped : vram->tile_cache->pixels;
+		return pixels + GBV_TILE_WIDTH * row_index;
+	}
+	decode_rows(vram->tile_data + GBV_TILE_PITCH * row_index, 1, (gbv_u8*)tmp);
+	if (flip) {
+		*tmp = flip_row(*tmp);
+	}
+	return (gbv_u8*)tmp;
+}
+
+/* copy count palette indices of a pre-rendered layer row starting at map_x, wrapping around at the right edge */
+static void copy_bg_layer_span(const gbv_u8 * layer_row, gbv_u8 * out, gbv_u8 map_x, gbv_u8 count) {
+	gbv_u16 first = GBV_MIN(count, BG_LAYER_PITCH - map_x);
+	memcpy(out, layer_row + map_x, first);
+	memcpy(out + first, layer_row, count - first);
+}
+
+/*
+  fetch count bg/wnd palette indices starting at position (map_x, map_y) of tile map 0 or 1, one tile row per 8 pixels
+  signed_ids is GBV_LCDC_BG_DATA_SELECT of the line, a template argument so the id mapping doesn't branch
+*/
+template <gbv_u8 signed_ids>
+static void fetch_tile_span(const vram_view * vram, gbv_u8 map, gbv_u8 * out, gbv_u8 map_x, gbv_u8 map_y, gbv_u8 count) {
+	if (vram->bg_layers) {
+		const gbv_u8 * layer = vram->bg_layers->pixels[2 * map + signed_ids];
+		copy_bg_layer_span(layer + BG_LAYER_PITCH * map_y, out, map_x, count);
+		return;
+	}
+	const gbv_u8 * tile_map = map ? vram->tile_map1 : vram->tile_map0;
+	const gbv_u8 * map_row = tile_map + GBV_BG_TILES_X * (map_y / GBV_TILE_HEIGHT);
+	const gbv_u16 tile_base = signed_ids ? 0x800 / GBV_TILE_SIZE : 0;
+	gbv_u8 py = map_y % GBV_TILE_HEIGHT;
+
+	/* partial first tile */
+	gbv_u8 px = map_x % GBV_TILE_WIDTH;
+	gbv_u8 tile_count = (px + count + GBV_TILE_WIDTH - 1) / GBV_TILE_WIDTH;
+	gbv_u8 tx = map_x / GBV_TILE_WIDTH;
+
+	/* fetch all rows of the span, then decode them at once */
+	unsigned long long decoded[GBV_SCREEN_WIDTH / GBV_TILE_WIDTH + 1];
+	if (vram->tile_cache) {
+		unsigned long long * pixels = (unsigned long long*)vram->tile_cache->pixels;
+		for (gbv_u8 i = 0; i < tile_count; i++) {
+			gbv_u8 tile_id = map_row[(tx + i) % GBV_BG_TILES_X];
+			tile_id = signed_ids ? (~tile_id + 1) : tile_id;
+			decoded[i] = pixels[GBV_TILE_HEIGHT * (tile_base + tile_id) + py];
+		}
+	}
+	else {
+		gbv_u8 rows[GBV_TILE_PITCH * (GBV_SCREEN_WIDTH / GBV_TILE_WIDTH + 1)] = {};
+		for (gbv_u8 i = 0; i < tile_count; i++) {
+			gbv_u8 tile_id = map_row[(tx + i) % GBV_BG_TILES_X];
+			tile_id = signed_ids ? (~tile_id + 1) : tile_id;
+			gbv_u8 * row = vram->tile_data + GBV_TILE_SIZE * (tile_base + tile_id) + GBV_TILE_PITCH * py;
+			rows[2 * i] = row[0];
+			rows[2 * i + 1] = row[1];
+		}
+		decode_rows(rows, tile_count, (gbv_u8*)decoded);
+	}
+
+	memcpy(out, (gbv_u8*)decoded + px, count);
+}
+
+/*
+  rasterize the selected objects of one scanline into a line buffer
+    - each entry holds palette index, palette select and priority flag of the visible object pixel
+    - objects are visited in OAM order, a pixel may only be replaced while it is empty or behind bg,
+      so the first object drawn above bg wins, otherwise the last one drawn behind bg
+*/
+static void fetch_obj_line(const vram_view * vram, const line_input * input, gbv_u8 * obj_line, gbv_u8 lcd_y) {
+	// TODO: properly support order of sprites with coinciding x values
+	for (gbv_u8 idx = 0; idx < input->obj_count; idx++) {
+		gbv_obj_char * obj = vram->oam_data + input->objs[idx];
+		int x_min = GBV_MAX(obj->x - GBV_SPRITE_MARGIN_LEFT, 0);
+		int x_max = GBV_MIN(obj->x, GBV_SCREEN_WIDTH);
+		if (x_min >= x_max) {
+			continue;
+		}
+		gbv_u8 py = lcd_y + GBV_SPRITE_MARGIN_TOP - obj->y;
+		if (obj->attr & GBV_OBJ_ATTR_FLIP_HORIZONTAL) {
+			py = GBV_TILE_HEIGHT - 1 - py;
+		}
+		unsigned long long tmp;
+		gbv_u8 * row = get_tile_row_indices(vram, GBV_TILE_HEIGHT * obj->id + py, obj->attr & GBV_OBJ_ATTR_FLIP_VERTICAL, &tmp);
+		gbv_u8 flags = obj->attr & (GBV_OBJ_ATTR_PALETTE_SELECT | GBV_OBJ_ATTR_PRIORITY_FLAG);
+		for (int lcd_x = x_min; lcd_x < x_max; lcd_x++) {
+			gbv_u8 pal_idx = row[lcd_x + GBV_SPRITE_MARGIN_LEFT - obj->x];
+			if (pal_idx && (!obj_line[lcd_x] || (obj_line[lcd_x] & GBV_OBJ_ATTR_PRIORITY_FLAG))) {
+				obj_line[lcd_x] = pal_idx | flags;
 			}
 		}
+	}
+}
+
+/* convert 0xAARRGGBB to the word layout of a 32 bit render mode */
+static gbv_u32 convert_color(gbv_u32 argb, gbv_render_mode mode) {
+	switch (mode) {
+	case GBV_RENDER_MODE_RGBA8888:
+		return (argb << 8) | (argb >> 24);
+	case GBV_RENDER_MODE_ABGR8888:
+		return (argb & 0xFF00FF00) | ((argb >> 16) & 0xFF) | ((argb & 0xFF) << 16);
+	case GBV_RENDER_MODE_BGRA8888:
+		return (argb << 24) | ((argb << 8) & 0x00FF0000) | ((argb >> 8) & 0x0000FF00) | (argb >> 24);
+	case GBV_RENDER_MODE_XRGB8888:
+		return argb | 0xFF000000;
+	default:
+		return argb;
+	}
+}
+
+static render_output get_render_output(const gbv_render_target * target) {
+	render_output output;
+	output.buffer = (gbv_u8*)target->buffer;
+	output.sink = 0;
+	output.sink_user_data = 0;
+	output.epx = target->scale == GBV_SCALE_EPX;
+	output.scale = output.epx ? 2 : (gbv_u8)target->scale + 1;
+	switch (target->mode) {
+	case GBV_RENDER_MODE_GRAYSCALE_8:
+		output.format = OUTPUT_FORMAT_8;
+		output.pitch = output.scale * GBV_SCREEN_WIDTH;
+		break;
+	case GBV_RENDER_MODE_PACKED_2:
+		/* not scaled */
+		output.format = OUTPUT_FORMAT_PACKED_2;
+		output.pitch = GBV_PACKED_PITCH;
+		output.scale = 1;
+		output.epx = 0;
+		break;
+	default:
+		output.format = OUTPUT_FORMAT_32;
+		output.pitch = 4 * output.scale * GBV_SCREEN_WIDTH;
+		break;
+	}
+	if (target->pitch) {
+		output.pitch = target->pitch;
+	}
+	fill_memory(output.colors8, sizeof(output.colors8), 0);
+	for (gbv_u8 i = 0; i < 4; i++) {
+		output.colors8[i] = target->palette ? target->palette->colors[i] : 0;
+		gbv_u32 argb;
+		if (target->palette32) {
+			argb = target->palette32->colors[i];
+		}
 		else {
-			/* background is off, clear screen */
-			for (gbv_u16 i = 0; i < GBV_SCREEN_SIZE; i++) {
-				buffer[i] = 0xFF;
-			}
-		}
-		if (gbv_io_lcdc & GBV_LCDC_WND_ENABLE) {
-			/* window enabled */
-			for (gbv_u8 ty = 0; ty < GBV_BG_TILES_Y; ty++) {
-				for (gbv_u8 tx = 0; tx < GBV_BG_TILES_X; tx++) {
-					gbv_u8 * tile = get_tile_from_tilemap(tx, ty, GBV_LCDC_WND_MAP_SELECT);
-					for (gbv_u8 y = 0; y < GBV_TILE_HEIGHT; y++) {
-						gbv_u8 * row = tile + GBV_TILE_PITCH * y;
-						for (gbv_u8 x = 0; x < GBV_TILE_WIDTH; x++) {
-							gbv_u16 screen_x = (GBV_TILE_WIDTH * tx + x) + gbv_io_wx - 7;
-							gbv_u16 screen_y = (GBV_TILE_HEIGHT * ty + y) + gbv_io_wy;
-							/* clipping */
-							if (screen_x < GBV_SCREEN_WIDTH && screen_y < GBV_SCREEN_HEIGHT) {
-								gbv_u8 color = get_pixel_from_tile_row(row, x, gbv_io_bgp);
-								gbv_u16 index = screen_y * GBV_SCREEN_WIDTH + screen_x;
-								buffer[index] = palette->colors[color];
-							}
-						}
-					}
-				}
-			}
+			/* gray levels of the 8 bit palette */
+			argb = 0xFF000000 | (output.colors8[i] << 16) | (output.colors8[i] << 8) | output.colors8[i];
 		}
-		if (gbv_io_lcdc & GBV_LCDC_OBJ_ENABLE) {
-			/* TODO: 8x16 mode */
-			/* render per scanline */
-			for (gbv_u8 y = 0; y < GBV_SCREEN_HEIGHT; y++) {
-				/* search oam */
-				gbv_u8 obj_count = 0;
-				gbv_u8 objs[MAX_OBJECTS_PER_SCANLINE];
-				for (gbv_u8 idx = 0; idx < GBV_OBJ_COUNT; idx++) {
-					gbv_obj_char *obj = gbv_oam_data + idx;
-					if (obj->y <= y + GBV_SPRITE_MARGIN_TOP  && obj->y + 8 > y + GBV_SPRITE_MARGIN_TOP) {
-						if (obj_count < MAX_OBJECTS_PER_SCANLINE) {
-							objs[obj_count++] = idx;
-						}
-					}
-				}
-				if (obj_count) {
-					/* objs array contains all sprites that get hit by this scanline */
-					/* array is sorted by ascending indices */
-					for (gbv_u8 idx = obj_count; idx > 0; idx--) {
-						gbv_obj_char *obj = gbv_oam_data + objs[idx - 1];
-						gbv_tile *tile = gbv_get_tile(obj->id);
-						if (obj->x < GBV_SPRITE_MARGIN_LEFT + GBV_SCREEN_WIDTH) {
-							gbv_u8 min_x, max_x;
-							min_x = (obj->x < GBV_SPRITE_MARGIN_LEFT) ? GBV_SPRITE_MARGIN_LEFT - obj->x : 0;
-							/* TODO: yuk */
-							if (min_x >= GBV_SPRITE_MARGIN_LEFT + GBV_SCREEN_WIDTH) {
-								max_x = min_x;
-							}
-							else {
-								max_x = (obj->x + GBV_TILE_WIDTH > GBV_SPRITE_MARGIN_LEFT + GBV_SCREEN_WIDTH) ? GBV_SPRITE_MARGIN_LEFT + GBV_SCREEN_WIDTH - obj->x : GBV_TILE_WIDTH;
-							}
-							/* TODO: handle flipH/flipV */
-							gbv_u8 src_y = GBV_SPRITE_MARGIN_TOP + y - obj->y;
-							for (gbv_u8 src_x = min_x; src_x < max_x; src_x++) {
-								gbv_u8 pal_idx = get_pal_idx_from_tile_row(tile->data[src_y], src_x);
-								if(pal_idx != 0x00) {
-									gbv_u8 color = get_color(pal_idx, (obj->attr & GBV_OBJ_ATTR_PALETTE_SELECT) ? gbv_io_obp1 : gbv_io_obp0);
-									gbv_u8 dst_x, dst_y;
-									dst_x = obj->x + src_x - GBV_SPRITE_MARGIN_LEFT;
-									dst_y = y;
-									gbv_u16 offset = dst_y * GBV_SCREEN_WIDTH + dst_x;
-									// TODO: Fix window priority
-									if (!(obj->attr & GBV_OBJ_ATTR_PRIORITY_FLAG) || (obj->attr & GBV_OBJ_ATTR_PRIORITY_FLAG && buffer[offset] == 0x00)) {
-										buffer[offset] = palette->colors[color];
-									}
-								}
-							}
-						}
-					}
-				}
+		output.colors32[i] = convert_color(argb, target->mode);
+	}
+	return output;
+}
+
+static gbv_u8 * get_output_row(const render_output * output, gbv_u16 row) {
+	return output->buffer + output->pitch * row;
+}
+
+/* map count shades to output colors, each one repeated scale times */
+static void write_shades(const render_output * output, gbv_u8 * dst, const gbv_u8 * shades, gbv_u16 count, gbv_u8 scale) {
+	if (output->format == OUTPUT_FORMAT_32) {
+		gbv_u32 * dst32 = (gbv_u32*)dst;
+		for (gbv_u16 i = 0; i < count; i++) {
+			gbv_u32 color = output->colors32[shades[i]];
+			for (gbv_u8 k = 0; k < scale; k++) {
+				*dst32++ = color;
 			}
 		}
 	}
+	else if (scale == 1) {
+		remap_bytes(output->colors8, shades, dst, count);
+	}
 	else {
-		/* LCD is off, clear screen */
-		for (gbv_u16 i = 0; i < GBV_SCREEN_SIZE; i++) {
-			buffer[i] = 0xFF;
+		for (gbv_u16 i = 0; i < count; i++) {
+			gbv_u8 color = output->colors8[shades[i]];
+			for (gbv_u8 k = 0; k < scale; k++) {
+				*dst++ = color;
+			}
+		}
+	}
+}
+
+/* nearest neighbor output of one scanline, the first output row is written and then copied */
+static void write_line(const render_output * output, gbv_u8 lcd_y, const gbv_u8 * shades) {
+	gbv_u8 * dst = get_output_row(output, output->scale * lcd_y);
+	if (output->format == OUTPUT_FORMAT_PACKED_2) {
+		/* first pixel in the high bits */
+		for (gbv_u8 i = 0; i < GBV_PACKED_PITCH; i++) {
+			const gbv_u8 * src = shades + 4 * i;
+			dst[i] = (src[0] << 6) | (src[1] << 4) | (src[2] << 2) | src[3];
+		}
+		return;
+	}
+	write_shades(output, dst, shades, GBV_SCREEN_WIDTH, output->scale);
+	gbv_u16 row_size = (output->format == OUTPUT_FORMAT_32 ? 4 : 1) * output->scale * GBV_SCREEN_WIDTH;
+	for (gbv_u8 row = 1; row < output->scale; row++) {
+		gbv_u8 * copy = get_output_row(output, output->scale * lcd_y + row);
+		for (gbv_u16 i = 0; i < row_size; i++) {
+			copy[i] = dst[i];
+		}
+	}
+}
+
+/*
+  scale2x/EPX output of one scanline, above and below are the neighboring lines
+  or the line itself at the top and bottom edge
+*/
+static void write_line_epx(const render_output * output, gbv_u8 lcd_y, const gbv_u8 * above, const gbv_u8 * line, const gbv_u8 * below) {
+	gbv_u8 top[2 * GBV_SCREEN_WIDTH];
+	gbv_u8 bottom[2 * GBV_SCREEN_WIDTH];
+	for (gbv_u8 x = 0; x < GBV_SCREEN_WIDTH; x++) {
+		gbv_u8 p = line[x];
+		gbv_u8 a = above[x];
+		gbv_u8 d = below[x];
+		gbv_u8 l = line[x ? x - 1 : x];
+		gbv_u8 r = line[x < GBV_SCREEN_WIDTH - 1 ? x + 1 : x];
+		if (a != d && l != r) {
+			top[2 * x]        = (l == a) ? l : p;
+			top[2 * x + 1]    = (a == r) ? r : p;
+			bottom[2 * x]     = (l == d) ? l : p;
+			bottom[2 * x + 1] = (d == r) ? r : p;
+		}
+		else {
+			top[2 * x] = top[2 * x + 1] = bottom[2 * x] = bottom[2 * x + 1] = p;
+		}
+	}
+	write_shades(output, get_output_row(output, 2 * lcd_y), top, 2 * GBV_SCREEN_WIDTH, 1);
+	write_shades(output, get_output_row(output, 2 * lcd_y + 1), bottom, 2 * GBV_SCREEN_WIDTH, 1);
+}
+
+static gbv_u8 * get_emitter_line(line_emitter * emitter, gbv_u8 lcd_y) {
+	return emitter->shades[lcd_y % 3];
+}
+
+/* hand the output rows of finished lines to the line sink, in order */
+static void notify_lines(const render_output * output, gbv_u8 first_line, gbv_u8 end_line) {
+	if (output->sink) {
+		for (gbv_u8 lcd_y = first_line; lcd_y < end_line; lcd_y++) {
+			output->sink(lcd_y, get_output_row(output, output->scale * lcd_y), output->scale, output->pitch, output->sink_user_data);
+		}
+	}
+}
+
+/* called after the shades of lcd_y were stored in the emitter */
+static void emit_line(const render_output * output, line_emitter * emitter, gbv_u8 lcd_y) {
+	if (!output->epx) {
+		write_line(output, lcd_y, get_emitter_line(emitter, lcd_y));
+		notify_lines(output, lcd_y, lcd_y + 1);
+		return;
+	}
+	if (lcd_y > 0) {
+		gbv_u8 above = (lcd_y > 1) ? lcd_y - 2 : 0;
+		write_line_epx(output, lcd_y - 1, get_emitter_line(emitter, above), get_emitter_line(emitter, lcd_y - 1), get_emitter_line(emitter, lcd_y));
+		notify_lines(output, lcd_y - 1, lcd_y);
+	}
+	if (lcd_y == GBV_SCREEN_HEIGHT - 1) {
+		gbv_u8 above = (lcd_y > 0) ? lcd_y - 1 : 0;
+		write_line_epx(output, lcd_y, get_emitter_line(emitter, above), get_emitter_line(emitter, lcd_y), get_emitter_line(emitter, lcd_y));
+		notify_lines(output, lcd_y, lcd_y + 1);
+	}
+}
+
+/* first window pixel of a line, GBV_SCREEN_WIDTH if the window isn't visible on it */
+static gbv_u8 get_window_start(const gbv_io_regs * io, gbv_u8 lcd_y) {
+	if (io->lcdc & GBV_LCDC_WND_ENABLE && lcd_y >= io->wy && io->wx - 7 < GBV_SCREEN_WIDTH) {
+		/* window starts at WX - 7 */
+		return (gbv_u8)GBV_MAX(io->wx - 7, 0);
+	}
+	return GBV_SCREEN_WIDTH;
+}
+
+/* build the layers read by the bg and wnd of a line that don't exist yet, the shadow copies have to be in sync */
+static void prepare_bg_layers(bg_layer_data * layers, const gbv_io_regs * io, gbv_u8 lcd_y) {
+	gbv_u8 signed_ids = (io->lcdc & GBV_LCDC_BG_DATA_SELECT) ? 1 : 0;
+	if (io->lcdc & GBV_LCDC_BG_ENABLE) {
+		gbv_u8 layer = 2 * ((io->lcdc & GBV_LCDC_BG_MAP_SELECT) ? 1 : 0) + signed_ids;
+		if (!layers->valid[layer]) {
+			build_bg_layer(layers, layer);
+		}
+	}
+	if (get_window_start(io, lcd_y) < GBV_SCREEN_WIDTH) {
+		gbv_u8 layer = 2 * ((io->lcdc & GBV_LCDC_WND_MAP_SELECT) ? 1 : 0) + signed_ids;
+		if (!layers->valid[layer]) {
+			build_bg_layer(layers, layer);
+		}
+	}
+}
+
+/* line kernel selection, LCDC bits and line contents that stay the same for a whole scanline */
+enum line_kernel_flag {
+	LINE_KERNEL_BG     = 0x01, /* GBV_LCDC_BG_ENABLE */
+	LINE_KERNEL_WND    = 0x02, /* window visible on this line */
+	LINE_KERNEL_OBJ    = 0x04, /* GBV_LCDC_OBJ_ENABLE and objects selected on this line */
+	LINE_KERNEL_SIGNED = 0x08, /* GBV_LCDC_BG_DATA_SELECT */
+	LINE_KERNEL_COUNT  = 0x10,
+};
+
+typedef void (*line_kernel_func)(const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 wnd_start, gbv_u8 * tags);
+
+/*
+  pixel tags: the palette of the layer a pixel came from in bits 2-3, its palette index in bits 0-1
+  rendering composes tags first and maps them to shades with one table load per pixel
+*/
+enum pixel_tag {
+	PIXEL_TAG_BLANK = 0x00, /* disabled bg, always shade 0 */
+	PIXEL_TAG_BGP   = 0x04,
+	PIXEL_TAG_OBP0  = 0x08,
+	PIXEL_TAG_OBP1  = 0x0C,
+};
+
+/* shades of all pixel tags, composed from BGP, OBP0 and OBP1 */
+struct tag_palette {
+	gbv_u8 shades[16];
+};
+
+static void build_tag_palette(const gbv_io_regs * io, tag_palette * palette) {
+	for (gbv_u8 i = 0; i < 4; i++) {
+		palette->shades[PIXEL_TAG_BLANK + i] = 0;
+		palette->shades[PIXEL_TAG_BGP + i] = get_color(i, io->bgp);
+		palette->shades[PIXEL_TAG_OBP0 + i] = get_color(i, io->obp0);
+		palette->shades[PIXEL_TAG_OBP1 + i] = get_color(i, io->obp1);
+	}
+}
+
+/* tag of an object line buffer entry */
+static gbv_u8 get_obj_tag(gbv_u8 obj) {
+	return PIXEL_TAG_OBP0 | ((obj & GBV_OBJ_ATTR_PALETTE_SELECT) >> 2) | (obj & 0x03);
+}
+
+/* tag count bg/wnd palette indices with layer, objects on top where they are visible */
+template <gbv_u8 has_objs>
+static void compose_span(gbv_u8 layer, const gbv_u8 * bg_line, const gbv_u8 * obj_line, gbv_u8 count, gbv_u8 * tags) {
+	for (gbv_u8 i = 0; i < count; i++) {
+		gbv_u8 pal_idx = bg_line[i];
+		if (has_objs) {
+			gbv_u8 obj = obj_line[i];
+			if (obj && (!(obj & GBV_OBJ_ATTR_PRIORITY_FLAG) || !pal_idx)) {
+				tags[i] = get_obj_tag(obj);
+				continue;
+			}
 		}
+		tags[i] = layer | pal_idx;
+	}
+}
+
+/* pixel transfer of one scanline, instantiated for every combination of line_kernel_flag */
+template <gbv_u8 flags>
+static void render_line_kernel(const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 wnd_start, gbv_u8 * tags) {
+	const gbv_io_regs * io = &input->io;
+	const gbv_u8 has_bg = flags & LINE_KERNEL_BG;
+	const gbv_u8 has_wnd = flags & LINE_KERNEL_WND;
+	const gbv_u8 has_objs = flags & LINE_KERNEL_OBJ;
+	const gbv_u8 signed_ids = (flags & LINE_KERNEL_SIGNED) ? 1 : 0;
+	if (!has_wnd) {
+		wnd_start = GBV_SCREEN_WIDTH;
 	}
+
+	gbv_u8 bg_line[GBV_SCREEN_WIDTH];
+	if (has_bg) {
+		gbv_u8 map = (io->lcdc & GBV_LCDC_BG_MAP_SELECT) ? 1 : 0;
+		fetch_tile_span<signed_ids>(vram, map, bg_line, io->scx, lcd_y + io->scy, wnd_start);
+	}
+	else {
+		fill_memory(bg_line, wnd_start, 0);
+	}
+	if (has_wnd) {
+		/* window starts at WX - 7 */
+		gbv_u8 map = (io->lcdc & GBV_LCDC_WND_MAP_SELECT) ? 1 : 0;
+		gbv_u8 win_x = wnd_start + 7 - io->wx;
+		gbv_u8 win_y = lcd_y - io->wy;
+		fetch_tile_span<signed_ids>(vram, map, bg_line + wnd_start, win_x, win_y, GBV_SCREEN_WIDTH - wnd_start);
+	}
+
+	gbv_u8 obj_line[GBV_SCREEN_WIDTH];
+	if (has_objs) {
+		fill_memory(obj_line, GBV_SCREEN_WIDTH, 0);
+		fetch_obj_line(vram, input, obj_line, lcd_y);
+	}
+
+	/* disabled bg is not mapped through bgp */
+	compose_span<has_objs>(has_bg ? PIXEL_TAG_BGP : PIXEL_TAG_BLANK, bg_line, obj_line, wnd_start, tags);
+	if (has_wnd) {
+		compose_span<has_objs>(PIXEL_TAG_BGP, bg_line + wnd_start, obj_line + wnd_start, GBV_SCREEN_WIDTH - wnd_start, tags + wnd_start);
+	}
+}
+
+static const line_kernel_func line_kernels[LINE_KERNEL_COUNT] = {
+	render_line_kernel<0x00>, render_line_kernel<0x01>, render_line_kernel<0x02>, render_line_kernel<0x03>,
+	render_line_kernel<0x04>, render_line_kernel<0x05>, render_line_kernel<0x06>, render_line_kernel<0x07>,
+	render_line_kernel<0x08>, render_line_kernel<0x09>, render_line_kernel<0x0A>, render_line_kernel<0x0B>,
+	render_line_kernel<0x0C>, render_line_kernel<0x0D>, render_line_kernel<0x0E>, render_line_kernel<0x0F>,
+};
+
+static unsigned long long hash_word(unsigned long long hash, unsigned long long word) {
+	hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+	return hash ^ (hash >> 32);
+}
+
+static unsigned long long hash_map_row(unsigned long long hash, const gbv_u8 * tile_map, gbv_u8 map_y) {
+	const unsigned long long * row = (const unsigned long long*)(tile_map + GBV_BG_TILES_X * (map_y / GBV_TILE_HEIGHT));
+	for (gbv_u8 i = 0; i < GBV_BG_TILES_X / 8; i++) {
+		hash = hash_word(hash, row[i]);
+	}
+	return hash;
+}
+
+/*
+  hash the inputs of a scanline: LCDC, scroll and window position, the tile map rows read by bg and wnd
+  and the OAM entries of the selected objects, palettes are applied after the line cache
+*/
+static unsigned long long hash_line(const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 wnd_start, gbv_u8 flags) {
+	const gbv_io_regs * io = &input->io;
+	unsigned long long hash = hash_word(0, flags | (io->lcdc << 8) | (wnd_start << 16));
+	if (flags & LINE_KERNEL_BG) {
+		const gbv_u8 * tile_map = (io->lcdc & GBV_LCDC_BG_MAP_SELECT) ? vram->tile_map1 : vram->tile_map0;
+		hash = hash_word(hash, io->scx | (io->scy << 8));
+		hash = hash_map_row(hash, tile_map, lcd_y + io->scy);
+	}
+	if (flags & LINE_KERNEL_WND) {
+		const gbv_u8 * tile_map = (io->lcdc & GBV_LCDC_WND_MAP_SELECT) ? vram->tile_map1 : vram->tile_map0;
+		hash = hash_word(hash, io->wx | (io->wy << 8));
+		hash = hash_map_row(hash, tile_map, lcd_y - io->wy);
+	}
+	if (flags & LINE_KERNEL_OBJ) {
+		for (gbv_u8 i = 0; i < input->obj_count; i++) {
+			hash = hash_word(hash, *(const gbv_u32*)(vram->oam_data + input->objs[i]));
+		}
+	}
+	return hash;
+}
+
+static gbv_u8 map_row_changed(const line_cache_data * cache, const gbv_u8 * tile_map, gbv_u8 map_y, gbv_u8 signed_ids, gbv_u32 generation) {
+	const gbv_u8 * row = tile_map + GBV_BG_TILES_X * (map_y / GBV_TILE_HEIGHT);
+	for (gbv_u8 i = 0; i < GBV_BG_TILES_X; i++) {
+		if (cache->tile_generation[get_map_tile_index(row[i], signed_ids)] > generation) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* check if any tile a scanline may read changed after generation, only when tile data changed at all */
+static gbv_u8 line_tiles_changed(const line_cache_data * cache, const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 flags, gbv_u32 generation) {
+	if (cache->generation == generation) {
+		return 0;
+	}
+	const gbv_io_regs * io = &input->io;
+	gbv_u8 signed_ids = (flags & LINE_KERNEL_SIGNED) ? 1 : 0;
+	if (flags & LINE_KERNEL_BG) {
+		const gbv_u8 * tile_map = (io->lcdc & GBV_LCDC_BG_MAP_SELECT) ? vram->tile_map1 : vram->tile_map0;
+		if (map_row_changed(cache, tile_map, lcd_y + io->scy, signed_ids, generation)) {
+			return 1;
+		}
+	}
+	if (flags & LINE_KERNEL_WND) {
+		const gbv_u8 * tile_map = (io->lcdc & GBV_LCDC_WND_MAP_SELECT) ? vram->tile_map1 : vram->tile_map0;
+		if (map_row_changed(cache, tile_map, lcd_y - io->wy, signed_ids, generation)) {
+			return 1;
+		}
+	}
+	if (flags & LINE_KERNEL_OBJ) {
+		for (gbv_u8 i = 0; i < input->obj_count; i++) {
+			/* same row as fetch_obj_line, 8x16 objects and flipped rows may reach into other tiles */
+			const gbv_obj_char * obj = vram->oam_data + input->objs[i];
+			gbv_u8 py = lcd_y + GBV_SPRITE_MARGIN_TOP - obj->y;
+			if (obj->attr & GBV_OBJ_ATTR_FLIP_HORIZONTAL) {
+				py = GBV_TILE_HEIGHT - 1 - py;
+			}
+			gbv_u16 tile = (GBV_TILE_HEIGHT * obj->id + py) / GBV_TILE_HEIGHT;
+			if (cache->tile_generation[tile] > generation) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* pixel tags of a scanline, reused from the previous frame when its inputs didn't change */
+static const gbv_u8 * render_cached_line(line_cache_data * cache, const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 wnd_start, gbv_u8 flags) {
+	cached_line * line = cache->lines + lcd_y;
+	unsigned long long hash = hash_line(vram, input, lcd_y, wnd_start, flags);
+	if (line->valid && line->hash == hash && !line_tiles_changed(cache, vram, input, lcd_y, flags, line->generation)) {
+		line->result = LINE_CACHE_HIT;
+		return line->tags;
+	}
+	line_kernels[flags](vram, input, lcd_y, wnd_start, line->tags);
+	line->hash = hash;
+	line->generation = cache->generation;
+	line->valid = 1;
+	line->result = LINE_CACHE_MISS;
+	return line->tags;
+}
+
+/* compare the shades of a line with the previous frame, lines are independent so bands may do this in parallel */
+static void track_line_damage(damage_data * damage, gbv_u8 lcd_y, const gbv_u8 * shades) {
+	gbv_u8 * previous = damage->shades[lcd_y];
+	gbv_u8 first = 0;
+	gbv_u8 end = GBV_SCREEN_WIDTH;
+#ifdef GBV_X64
+	/* narrow down to the first and last 16 pixels that differ, the bytes are only compared in those */
+	gbv_u8 first_chunk = GBV_SCREEN_WIDTH;
+	gbv_u8 end_chunk = 0;
+	for (gbv_u8 i = 0; i < GBV_SCREEN_WIDTH; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(previous + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(shades + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+			first_chunk = GBV_MIN(first_chunk, i);
+			end_chunk = i + 16;
+		}
+	}
+	first = first_chunk;
+	end = end_chunk;
+#endif
+	while (first < end && previous[first] == shades[first]) {
+		first++;
+	}
+	while (end > first && previous[end - 1] == shades[end - 1]) {
+		end--;
+	}
+	if (first >= end) {
+		damage->x_first[lcd_y] = 0;
+		damage->x_end[lcd_y] = 0;
+		return;
+	}
+#ifdef GBV_X64
+	for (gbv_u8 i = 0; i < GBV_SCREEN_WIDTH; i += 16) {
+		_mm_storeu_si128((__m128i*)(previous + i), _mm_loadu_si128((const __m128i*)(shades + i)));
+	}
+#else
+	for (gbv_u8 i = first; i < end; i++) {
+		previous[i] = shades[i];
+	}
+#endif
+	damage->x_first[lcd_y] = first;
+	damage->x_end[lcd_y] = end;
+}
+
+/*
+  pixel transfer of one scanline, picks the kernel for the state of the line
+  the pixel tags are stored in tags when given, e.g. a row of the retained frame
+*/
+static void render_line(const vram_view * vram, const line_input * input, gbv_u8 lcd_y, gbv_u8 * shades, gbv_u8 * tags) {
+	const gbv_io_regs * io = &input->io;
+	gbv_u8 flags = 0;
+	gbv_u8 wnd_start = get_window_start(io, lcd_y);
+	if (wnd_start < GBV_SCREEN_WIDTH) {
+		flags |= LINE_KERNEL_WND;
+	}
+	if (io->lcdc & GBV_LCDC_BG_ENABLE) {
+		flags |= LINE_KERNEL_BG;
+	}
+	if ((io->lcdc & GBV_LCDC_OBJ_ENABLE) && input->obj_count) {
+		flags |= LINE_KERNEL_OBJ;
+	}
+	if (io->lcdc & GBV_LCDC_BG_DATA_SELECT) {
+		flags |= LINE_KERNEL_SIGNED;
+	}
+	gbv_u8 rendered[GBV_SCREEN_WIDTH];
+	const gbv_u8 * line_tags;
+	if (vram->line_cache) {
+		line_tags = render_cached_line(vram->line_cache, vram, input, lcd_y, wnd_start, flags);
+		if (tags) {
+			for (gbv_u8 i = 0; i < GBV_SCREEN_WIDTH; i++) {
+				tags[i] = line_tags[i];
+			}
+		}
+	}
+	else {
+		if (!tags) {
+			tags = rendered;
+		}
+		line_kernels[flags](vram, input, lcd_y, wnd_start, tags);
+		line_tags = tags;
+	}
+	tag_palette palette;
+	build_tag_palette(io, &palette);
+	remap_bytes(palette.shades, line_tags, shades, GBV_SCREEN_WIDTH);
+	if (vram->damage) {
+		track_line_damage(vram->damage, lcd_y, shades);
+	}
+}
+
+/*
+  bucket all objects by the scanlines they cover, keeping OAM order for the per line limit
+  the result is the same as searching all of OAM on every line
+*/
+static void build_oam_index(gbv_context * ctx, gbv_u8 obj_size) {
+	gbv_state * state = get_state(ctx);
+	oam_index_data * index = &state->oam_index;
+	unsigned long long * src = (unsigned long long*)state->oam_data;
+	unsigned long long * shadow = index->raw;
+	for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+		shadow[i] = src[i];
+	}
+	fill_memory(index->counts, GBV_SCREEN_HEIGHT, 0);
+
+	gbv_u8 step = obj_size ? 2 : 1;
+	gbv_u8 height = obj_size ? 2 * GBV_TILE_HEIGHT : GBV_TILE_HEIGHT;
+	for (gbv_u8 idx = 0; idx < GBV_OBJ_COUNT; idx += step) {
+		gbv_obj_char * obj = state->oam_data + idx;
+		int y_min = GBV_MAX(obj->y - GBV_SPRITE_MARGIN_TOP, 0);
+		int y_max = GBV_MIN(obj->y + height - GBV_SPRITE_MARGIN_TOP, GBV_SCREEN_HEIGHT);
+		for (int lcd_y = y_min; lcd_y < y_max; lcd_y++) {
+			if (index->counts[lcd_y] < MAX_OBJECTS_PER_SCANLINE) {
+				// TODO: figure out if sprite attributes from obj[0] or obj[1] is used in case of hit on obj[1]
+				gbv_u8 selected = (obj_size && lcd_y - obj->y >= GBV_TILE_HEIGHT) ? idx + 1 : idx;
+				index->objs[lcd_y][index->counts[lcd_y]++] = selected;
+			}
+		}
+	}
+	index->obj_size = obj_size;
+	index->valid = 1;
+}
+
+/* look up the objects selected for a scanline, picking up direct writes to OAM memory */
+static gbv_u8 search_oam(gbv_context * ctx, gbv_u8 lcd_y, gbv_u8 ** objs) {
+	gbv_state * state = get_state(ctx);
+	oam_index_data * index = &state->oam_index;
+	if (state->oam_index_stale) {
+		unsigned long long * src = (unsigned long long*)state->oam_data;
+		unsigned long long * shadow = index->raw;
+		for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+			if (src[i] != shadow[i]) {
+				index->valid = 0;
+				break;
+			}
+		}
+		state->oam_index_stale = 0;
+	}
+	gbv_u8 obj_size = ctx->io.lcdc & GBV_LCDC_OBJ_SIZE_SELECT;
+	if (!index->valid || index->obj_size != obj_size) {
+		build_oam_index(ctx, obj_size);
+	}
+	*objs = index->objs[lcd_y];
+	return index->counts[lcd_y];
+}
+
+static void trace_flush(gbv_state * state) {
+	trace_memory * trace = state->trace;
+	if (trace->used) {
+		state->trace_write(trace->buffer, trace->used, state->trace_user_data);
+		trace->used = 0;
+	}
+}
+
+static void trace_put(gbv_state * state, const gbv_u8 * data, gbv_u16 size) {
+	trace_memory * trace = state->trace;
+	while (size) {
+		if (trace->used == TRACE_BUFFER_SIZE) {
+			trace_flush(state);
+		}
+		gbv_u16 count = GBV_MIN(size, TRACE_BUFFER_SIZE - trace->used);
+		for (gbv_u16 i = 0; i < count; i++) {
+			trace->buffer[trace->used + i] = data[i];
+		}
+		trace->used += count;
+		data += count;
+		size -= count;
+	}
+}
+
+static void trace_put_u8(gbv_state * state, gbv_u8 a, gbv_u8 b) {
+	gbv_u8 record[2] = { a, b };
+	trace_put(state, record, 2);
+}
+
+/*
+  write the changed bytes of a memory range as runs and update the shadow copy
+  differences up to 8 bytes apart go into the same run, the unchanged bytes are cheaper than a new record
+*/
+static void trace_memory_range(gbv_state * state, gbv_u16 address, const gbv_u8 * memory, gbv_u8 * shadow, gbv_u16 size, gbv_u8 full) {
+	gbv_u16 i = 0;
+	while (i < size) {
+		if (!full && memory[i] == shadow[i]) {
+			i++;
+			continue;
+		}
+		gbv_u16 end = i + 1;
+		for (gbv_u16 j = end; j < size && j < end + 8; j++) {
+			if (full || memory[j] != shadow[j]) {
+				end = j + 1;
+			}
+		}
+		gbv_u16 run_address = address + i;
+		gbv_u16 length = end - i;
+		gbv_u8 header[5] = { TRACE_RECORD_MEM, (gbv_u8)run_address, (gbv_u8)(run_address >> 8), (gbv_u8)length, (gbv_u8)(length >> 8) };
+		trace_put(state, header, 5);
+		trace_put(state, memory + i, length);
+		for (gbv_u16 j = i; j < end; j++) {
+			shadow[j] = memory[j];
+		}
+		i = end;
+	}
+}
+
+/* record every change to registers, STAT interrupt enables, VRAM and OAM since the last call */
+static void trace_deltas(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	trace_memory * trace = state->trace;
+	gbv_u8 full = trace->full;
+	const gbv_u8 * regs = (const gbv_u8*)&ctx->io;
+	gbv_u8 * shadow_regs = (gbv_u8*)&trace->io;
+	for (gbv_u8 i = 0; i < sizeof(gbv_io_regs); i++) {
+		if (full || regs[i] != shadow_regs[i]) {
+			gbv_u8 record[3] = { TRACE_RECORD_REG, i, regs[i] };
+			trace_put(state, record, 3);
+			shadow_regs[i] = regs[i];
+		}
+	}
+	gbv_u8 stat = state->io_stat & ~(GBV_STAT_MODE | GBV_STAT_LYC);
+	if (full || stat != trace->stat) {
+		trace_put_u8(state, TRACE_RECORD_STAT, stat);
+		trace->stat = stat;
+	}
+	trace_memory_range(state, TRACE_VRAM_START, state->mem + TRACE_VRAM_START, trace->vram, TRACE_VRAM_SIZE, full);
+	trace_memory_range(state, TRACE_OAM_START, state->mem + TRACE_OAM_START, trace->oam, GBV_OAM_MEMORY_SIZE, full);
+	trace->full = 0;
+}
+
+/* start of a frame, everything written by the caller since the last frame belongs to it */
+static void trace_frame(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	/* the output holds whole frames */
+	trace_flush(state);
+	trace_put_u8(state, TRACE_RECORD_FRAME, state->lcdc_int_callback ? 1 : 0);
+	trace_deltas(ctx);
+}
+
+static void trace_callback(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	gbv_u8 record = TRACE_RECORD_CALLBACK;
+	trace_put(state, &record, 1);
+	trace_deltas(ctx);
+}
+
+/*
+  apply the records of a trace up to the next frame or callback record
+  returns 0 if a record is malformed
+*/
+static gbv_u8 play_trace_deltas(gbv_context * ctx, gbv_trace_player * player) {
+	gbv_state * state = get_state(ctx);
+	const gbv_u8 * data = (const gbv_u8*)player->data;
+	while (player->pos < player->size) {
+		const gbv_u8 * record = data + player->pos;
+		int left = player->size - player->pos;
+		switch (record[0]) {
+		case TRACE_RECORD_FRAME:
+		case TRACE_RECORD_CALLBACK:
+			return 1;
+		case TRACE_RECORD_REG:
+			if (left < 3 || record[1] >= sizeof(gbv_io_regs)) {
+				return 0;
+			}
+			((gbv_u8*)&ctx->io)[record[1]] = record[2];
+			player->pos += 3;
+			break;
+		case TRACE_RECORD_STAT:
+			if (left < 2) {
+				return 0;
+			}
+			state->io_stat = (state->io_stat & (GBV_STAT_MODE | GBV_STAT_LYC)) | (record[1] & ~(GBV_STAT_MODE | GBV_STAT_LYC));
+			player->pos += 2;
+			break;
+		case TRACE_RECORD_MEM: {
+			if (left < 5) {
+				return 0;
+			}
+			int address = record[1] | (record[2] << 8);
+			int length = record[3] | (record[4] << 8);
+			if (left - 5 < length || address + length > GBV_HW_MEMORY_SIZE) {
+				return 0;
+			}
+			for (int i = 0; i < length; i++) {
+				state->mem[address + i] = record[5 + i];
+			}
+			mark_dirty(state, address, length);
+			player->pos += 5 + length;
+			break;
+		}
+		default:
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* stands in for the recorded callback and applies what it changed */
+static void play_trace_callback(gbv_context * ctx, void * user_data) {
+	gbv_trace_player * player = (gbv_trace_player*)user_data;
+	const gbv_u8 * data = (const gbv_u8*)player->data;
+	if (player->pos < player->size && data[player->pos] == TRACE_RECORD_CALLBACK) {
+		player->pos++;
+		if (!play_trace_deltas(ctx, player)) {
+			player->pos = player->size;
+		}
+	}
+}
+
+/* returns 1 if the callback was invoked */
+gbv_u8 check_for_lcd_interrupts(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	if (state->lcdc_int_callback) {
+		gbv_lcd_mode mode = gbv_stat_mode_ctx(ctx);
+		if (state->stat_trig.ints[mode]) {
+			gbv_u8 trigger = 0;
+			switch (mode) {
+			case GBV_LCD_MODE_HBLANK:
+				trigger = state->io_stat & GBV_STAT_HBLANK_INT;
+				break;
+			case GBV_LCD_MODE_VBLANK:
+				trigger = state->io_stat & GBV_STAT_VBLANK_INT;
+				break;
+			case GBV_LCD_MODE_OAM:
+				trigger = state->io_stat & GBV_STAT_OAM_INT;
+				break;
+			case GBV_LCD_MODE_TRANSFER:
+				trigger = (state->io_stat & GBV_STAT_LYC_INT) && (state->io_stat & GBV_STAT_LYC);
+				break;
+			}
+			if (trigger) {
+				state->stat_trig.ints[mode] = 0;
+				GBV_STATS_TIMER(callback_start);
+				state->lcdc_int_callback(ctx, state->lcdc_int_user_data);
+				GBV_STATS_TIME(state, callback_ticks, callback_start);
+				GBV_STATS_ADD(state, callbacks, 1);
+				if (state->trace) {
+					trace_callback(ctx);
+				}
+				/* callback may have written to tile data or OAM */
+				state->caches_stale = 1;
+				state->write_serial++;
+				state->oam_index_stale = 1;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* interrupt source of each mode */
+static const gbv_u8 mode_int_flags[4] = {
+	GBV_STAT_HBLANK_INT,
+	GBV_STAT_VBLANK_INT,
+	GBV_STAT_OAM_INT,
+	GBV_STAT_LYC_INT,
+};
+
+gbv_u8 lcd_change_mode(gbv_context * ctx, gbv_lcd_mode mode) {
+	gbv_state * state = get_state(ctx);
+	state->io_stat = (state->io_stat & ~GBV_STAT_MODE) | (mode & GBV_STAT_MODE);
+	state->stat_trig.ints[mode] = true;
+	/* most mode changes have no enabled source, skip the interrupt check for them */
+	if (!state->lcdc_int_callback || !(state->io_stat & mode_int_flags[mode])) {
+		return 0;
+	}
+	return check_for_lcd_interrupts(ctx);
+}
+
+static vram_view get_live_view(gbv_state * state) {
+	vram_view view;
+	view.tile_data  = state->tile_data;
+	view.tile_map0  = state->tile_map0;
+	view.tile_map1  = state->tile_map1;
+	view.oam_data   = state->oam_data;
+	view.tile_cache = state->tile_cache;
+	view.bg_layers  = state->bg_layers;
+	view.line_cache = state->line_cache;
+	view.damage     = state->frame.damage ? state->damage : 0;
+	return view;
+}
+
+/* the tile cache and bg layers are kept in sync with the snapshot while band rendering is enabled */
+static vram_view get_band_view(gbv_state * state) {
+	vram_view view;
+	view.tile_data  = state->bands->vram;
+	view.tile_map0  = state->bands->vram + (state->tile_map0 - state->tile_data);
+	view.tile_map1  = state->bands->vram + (state->tile_map1 - state->tile_data);
+	view.oam_data   = state->bands->oam;
+	view.tile_cache = state->tile_cache;
+	view.bg_layers  = state->bg_layers;
+	view.line_cache = state->line_cache;
+	view.damage     = state->frame.damage ? state->damage : 0;
+	return view;
+}
+
+/* copy tile data, tile maps and OAM to the band snapshot */
+static void snapshot_vram(gbv_state * state) {
+	unsigned long long * vram = (unsigned long long*)state->tile_data;
+	unsigned long long * oam = (unsigned long long*)state->oam_data;
+	unsigned long long * vram_copy = (unsigned long long*)state->bands->vram;
+	unsigned long long * oam_copy = (unsigned long long*)state->bands->oam;
+	for (gbv_u16 i = 0; i < sizeof(state->bands->vram) / 8; i++) {
+		vram_copy[i] = vram[i];
+	}
+	for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+		oam_copy[i] = oam[i];
+	}
+	vram_view view = get_band_view(state);
+	sync_caches(state, &view);
+}
+
+static gbv_u8 vram_changed(gbv_state * state) {
+	unsigned long long * vram = (unsigned long long*)state->tile_data;
+	unsigned long long * oam = (unsigned long long*)state->oam_data;
+	unsigned long long * vram_copy = (unsigned long long*)state->bands->vram;
+	unsigned long long * oam_copy = (unsigned long long*)state->bands->oam;
+	unsigned long long diff = 0;
+	for (gbv_u16 i = 0; i < sizeof(state->bands->vram) / 8; i++) {
+		diff |= vram_copy[i] ^ vram[i];
+	}
+	for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+		diff |= oam_copy[i] ^ oam[i];
+	}
+	return diff != 0;
+}
+
+/* video memory and OAM are the same as at the start of the last tracked frame */
+static gbv_u8 same_damage_memory(gbv_state * state) {
+	unsigned long long * vram = (unsigned long long*)state->tile_data;
+	unsigned long long * oam = (unsigned long long*)state->oam_data;
+	unsigned long long * vram_copy = (unsigned long long*)state->damage->vram;
+	unsigned long long * oam_copy = (unsigned long long*)state->damage->oam;
+	unsigned long long diff = 0;
+	for (gbv_u16 i = 0; i < sizeof(state->damage->vram) / 8; i++) {
+		diff |= vram_copy[i] ^ vram[i];
+	}
+	for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+		diff |= oam_copy[i] ^ oam[i];
+	}
+	return diff == 0;
+}
+
+static gbv_u8 same_regs(const gbv_io_regs * a, const gbv_io_regs * b) {
+	return a->lcdc == b->lcdc && a->bgp == b->bgp && a->obp0 == b->obp0 && a->obp1 == b->obp1 && a->scx == b->scx &&
+		a->scy == b->scy && a->lyc == b->lyc && a->wx == b->wx && a->wy == b->wy;
+}
+
+/* the shades of the last tracked frame were written to the same buffer in the same format and colors */
+static gbv_u8 same_damage_output(const damage_data * damage, const render_output * output) {
+	gbv_u8 same = damage->buffer == output->buffer && damage->pitch == output->pitch && damage->format == output->format &&
+		damage->scale == output->scale && damage->epx == output->epx;
+	for (gbv_u8 i = 0; i < 4; i++) {
+		same = same && damage->colors8[i] == output->colors8[i] && damage->colors32[i] == output->colors32[i];
+	}
+	return same;
+}
+
+/*
+  called at the start of a frame with pixels, while the inputs equal those the last tracked frame started from,
+  its lines up to the first change are still in the buffer
+*/
+static void begin_damage_frame(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	damage_data * damage = state->damage;
+	const render_output * output = &frame->output;
+	gbv_u8 same_output = damage->valid && same_damage_output(damage, output);
+	gbv_u8 same_inputs = same_output && same_regs(&ctx->io, &damage->io) && same_damage_memory(state);
+	/* lines aren't emitted one by one for epx, a retained frame needs all lines as well */
+	gbv_u8 keep_lines = same_inputs && !output->epx && (!state->retained || state->retained_valid);
+	frame->damage = 1;
+	frame->unchanged = 1;
+	frame->skip_lines = keep_lines ? damage->static_lines : 0;
+	frame->write_serial = state->write_serial;
+	if (!same_inputs) {
+		unsigned long long * vram = (unsigned long long*)state->tile_data;
+		unsigned long long * oam = (unsigned long long*)state->oam_data;
+		unsigned long long * vram_copy = (unsigned long long*)damage->vram;
+		unsigned long long * oam_copy = (unsigned long long*)damage->oam;
+		for (gbv_u16 i = 0; i < sizeof(damage->vram) / 8; i++) {
+			vram_copy[i] = vram[i];
+		}
+		for (gbv_u8 i = 0; i < GBV_OBJ_SIZE / 8; i++) {
+			oam_copy[i] = oam[i];
+		}
+		damage->io = ctx->io;
+	}
+	if (!same_output) {
+		damage->buffer = output->buffer;
+		damage->pitch = output->pitch;
+		damage->format = output->format;
+		damage->scale = output->scale;
+		damage->epx = output->epx;
+		for (gbv_u8 i = 0; i < 4; i++) {
+			damage->colors8[i] = output->colors8[i];
+			damage->colors32[i] = output->colors32[i];
+		}
+	}
+	damage->full = !same_output;
+	damage->static_lines = GBV_SCREEN_HEIGHT;
+}
+
+/* called before a line uses the registers or video memory, the first change ends skipping for the rest of the frame */
+static void check_damage_inputs(gbv_context * ctx, gbv_u8 lcd_y) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	if (!frame->unchanged) {
+		return;
+	}
+	gbv_u8 changed = !same_regs(&ctx->io, &state->damage->io);
+	if (!changed && frame->write_serial != state->write_serial) {
+		/* writes may have stored the same values again */
+		changed = !same_damage_memory(state);
+		frame->write_serial = state->write_serial;
+	}
+	if (changed) {
+		frame->unchanged = 0;
+		state->damage->static_lines = lcd_y;
+	}
+}
+
+struct band_job {
+	band_memory * bands;
+	gbv_u8 * retained;
+	vram_view vram;
+	const render_output * output;
+	gbv_u8 first_line;
+	gbv_u8 line_count;
+	gbv_u8 band_count;
+};
+
+/* called by the parallel_for of the user, bands cover consecutive runs of lines */
+static void render_band(void * job_data, int band) {
+	band_job * job = (band_job*)job_data;
+	gbv_u8 first = job->first_line + job->line_count * band / job->band_count;
+	gbv_u8 last = job->first_line + job->line_count * (band + 1) / job->band_count;
+	for (gbv_u8 lcd_y = first; lcd_y < last; lcd_y++) {
+		gbv_u8 * tags = job->retained ? job->retained + GBV_SCREEN_WIDTH * lcd_y : 0;
+		if (job->output->epx) {
+			render_line(&job->vram, job->bands->lines + lcd_y, lcd_y, job->bands->shades[lcd_y], tags);
+		}
+		else {
+			gbv_u8 shades[GBV_SCREEN_WIDTH];
+			render_line(&job->vram, job->bands->lines + lcd_y, lcd_y, shades, tags);
+			write_line(job->output, lcd_y, shades);
+		}
+	}
+}
+
+/* epx output runs after the lines around a band are rendered */
+static void scale_band(void * job_data, int band) {
+	band_job * job = (band_job*)job_data;
+	gbv_u8 first = job->first_line + job->line_count * band / job->band_count;
+	gbv_u8 last = job->first_line + job->line_count * (band + 1) / job->band_count;
+	for (gbv_u8 lcd_y = first; lcd_y < last; lcd_y++) {
+		gbv_u8 above = (lcd_y > 0) ? lcd_y - 1 : lcd_y;
+		gbv_u8 below = (lcd_y < GBV_SCREEN_HEIGHT - 1) ? lcd_y + 1 : lcd_y;
+		write_line_epx(job->output, lcd_y, job->bands->shades[above], job->bands->shades[lcd_y], job->bands->shades[below]);
+	}
+}
+
+/* render the recorded lines from first_line up to end_line from the snapshot */
+static void flush_bands(gbv_state * state, gbv_u8 first_line, gbv_u8 end_line, const render_output * output) {
+	if (first_line >= end_line) {
+		return;
+	}
+	GBV_STATS_TIMER(transfer_start);
+	band_job job;
+	job.bands      = state->bands;
+	job.retained   = state->retained;
+	job.vram       = get_band_view(state);
+	job.output     = output;
+	job.first_line = first_line;
+	job.line_count = end_line - first_line;
+	job.band_count = GBV_MIN(state->band_count, job.line_count);
+	state->parallel_for(render_band, &job, job.band_count, state->parallel_for_user_data);
+
+	if (!output->epx) {
+		notify_lines(output, first_line, end_line);
+	}
+	else {
+		/* the last line waits for the one below it, unless it ends the frame */
+		gbv_u8 scale_first = (first_line > 0) ? first_line - 1 : 0;
+		gbv_u8 scale_end = (end_line < GBV_SCREEN_HEIGHT) ? end_line - 1 : end_line;
+		if (scale_first < scale_end) {
+			job.first_line = scale_first;
+			job.line_count = scale_end - scale_first;
+			job.band_count = GBV_MIN(state->band_count, job.line_count);
+			state->parallel_for(scale_band, &job, job.band_count, state->parallel_for_user_data);
+			notify_lines(output, scale_first, scale_end);
+		}
+	}
+	GBV_STATS_TIME(state, transfer_ticks, transfer_start);
+}
+
+/*
+  called after each interrupt callback while band rendering
+  recorded lines are rendered before a change to video memory becomes visible to them
+*/
+static void check_band_snapshot(gbv_state * state, gbv_u8 * first_line, gbv_u8 end_line, const render_output * output) {
+	if (vram_changed(state)) {
+		flush_bands(state, *first_line, end_line, output);
+		snapshot_vram(state);
+		*first_line = end_line;
+	}
+}
+
+/* writes of the caller between lines, also through the raw pointers, are picked up before the next line */
+static void check_external_writes(gbv_state * state) {
+	frame_state * frame = &state->frame;
+	if (!frame->external_writes) {
+		return;
+	}
+	frame->external_writes = 0;
+	state->caches_stale = 1;
+	state->oam_index_stale = 1;
+	state->write_serial++;
+	if (frame->bands) {
+		check_band_snapshot(state, &frame->first_pending, frame->recorded_end, &frame->output);
+	}
+}
+
+/* assume everything changed, memory may have been written through a raw pointer */
+static void mark_all_dirty(gbv_state * state) {
+	frame_state * frame = &state->frame;
+	state->write_serial++;
+	state->caches_stale = 1;
+	state->oam_index_stale = 1;
+	fill_memory(&state->dirty, sizeof(state->dirty), 0xFF);
+	state->dirty.all = 1;
+	if (frame->active && frame->bands) {
+		/* recorded lines are rendered before the writes become visible to them */
+		check_band_snapshot(state, &frame->first_pending, frame->recorded_end, &frame->output);
+	}
+}
+
+/* API functions */
+void gbv_get_version(int * maj, int * min, int * patch) {
+	if (maj) {
+		*maj = GBV_VERSION_MAJOR;
+	}
+	if (min) {
+		*min = GBV_VERSION_MINOR;
+	}
+	if (patch) {
+		*patch = GBV_VERSION_PATCH;
+	}
+}
+
+void gbv_init_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	ctx->io = {};
+	*state = {};
+	state->mem       = (gbv_u8*)memory;
+	state->tile_data = state->mem + 0x8000;
+	state->tile_map0 = state->mem + 0x9800;
+	state->tile_map1 = state->mem + 0x9C00;
+	state->oam_data  = (gbv_obj_char*)(state->mem + 0xFE00);
+	mark_all_dirty(state);
+}
+
+void gbv_lcdc_set_ctx(gbv_context * ctx, gbv_lcdc_flag flag) {
+	ctx->io.lcdc = ctx->io.lcdc | flag;
+}
+
+void gbv_lcdc_reset_ctx(gbv_context * ctx, gbv_lcdc_flag flag) {
+	ctx->io.lcdc = ctx->io.lcdc & ~flag;
+}
+
+void gbv_stat_set_ctx(gbv_context * ctx, gbv_stat_flag flag) {
+	gbv_state * state = get_state(ctx);
+	if (flag > GBV_STAT_LYC) {
+		state->io_stat = state->io_stat | flag;
+	}
+}
+
+void gbv_stat_reset_ctx(gbv_context * ctx, gbv_stat_flag flag) {
+	gbv_state * state = get_state(ctx);
+	if (flag > GBV_STAT_LYC) {
+		state->io_stat = state->io_stat & ~flag;
+	}
+}
+
+gbv_lcd_mode gbv_stat_mode_ctx(gbv_context * ctx) {
+	return (gbv_lcd_mode)(get_state(ctx)->io_stat & GBV_STAT_MODE);
+}
+
+gbv_u8 gbv_stat_lyc_ctx(gbv_context * ctx) {
+	return get_state(ctx)->io_stat & GBV_STAT_LYC;
+}
+
+gbv_io gbv_ly_ctx(gbv_context * ctx) {
+	return get_state(ctx)->io_ly;
+}
+
+gbv_u8 * gbv_get_rom_data_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	mark_all_dirty(state);
+	return state->mem;
+}
+
+gbv_u8 * gbv_get_tile_map0_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	mark_all_dirty(state);
+	return state->tile_map0;
+}
+
+gbv_u8 * gbv_get_tile_map1_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	mark_all_dirty(state);
+	return state->tile_map1;
+}
+
+gbv_u8 * gbv_get_tile_data_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	mark_all_dirty(state);
+	return state->tile_data;
+}
+
+gbv_tile * gbv_get_tile_ctx(gbv_context * ctx, gbv_u8 tile_id) {
+	gbv_state * state = get_state(ctx);
+	set_bits(state->dirty.tiles, tile_id, tile_id + 1);
+	state->write_serial++;
+	state->caches_stale = 1;
+	return (gbv_tile*)state->tile_data + tile_id;
+}
+
+int gbv_write_vram_ctx(gbv_context * ctx, int address, const void * src, int length) {
+	gbv_state * state = get_state(ctx);
+	if (address < 0 || length <= 0 || address >= GBV_HW_MEMORY_SIZE) {
+		return 0;
+	}
+	length = GBV_MIN(length, GBV_HW_MEMORY_SIZE - address);
+	const gbv_u8 * bytes = (const gbv_u8*)src;
+	for (int i = 0; i < length; i++) {
+		state->mem[address + i] = bytes[i];
+	}
+	mark_dirty(state, address, length);
+	/* caches pick up the write before the next line, also between gbv_render_scanline calls */
+	state->caches_stale = 1;
+	state->oam_index_stale = 1;
+	return length;
+}
+
+void gbv_write8_ctx(gbv_context * ctx, int address, gbv_u8 value) {
+	gbv_write_vram_ctx(ctx, address, &value, 1);
+}
+
+int gbv_get_dirty_ctx(gbv_context * ctx, gbv_dirty_regions * dirty) {
+	gbv_state * state = get_state(ctx);
+	*dirty = state->dirty;
+	const gbv_u8 * bytes = (const gbv_u8*)&state->dirty;
+	for (gbv_u16 i = 0; i < sizeof(state->dirty); i++) {
+		if (bytes[i]) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void gbv_clear_dirty_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	fill_memory(&state->dirty, sizeof(state->dirty), 0);
+}
+
+void gbv_mark_all_dirty_ctx(gbv_context * ctx) {
+	mark_all_dirty(get_state(ctx));
+}
+
+void gbv_lcdc_set_stat_interrupt_ctx(gbv_context * ctx, gbv_ctx_int_callback callback, void * user_data) {
+	gbv_state * state = get_state(ctx);
+	state->lcdc_int_callback = callback;
+	state->lcdc_int_user_data = user_data;
+}
+
+int gbv_set_decode_kernel(gbv_decode_kernel kernel) {
+	decode_rows_func func = find_decode_kernel(kernel);
+	if (!func) {
+		return 0;
+	}
+	/* decoded tiles don't depend on the kernel, no need to invalidate the cache */
+	decode_rows = func;
+	return 1;
+}
+
+void gbv_decode_tile_rows(const gbv_u8 * rows, int count, gbv_u8 * indices) {
+	decode_rows(rows, (gbv_u16)count, indices);
+}
+
+void gbv_convert_packed(const void * packed, int packed_pitch, const gbv_render_target * target) {
+	render_output output = get_render_output(target);
+	const gbv_u8 * src = (const gbv_u8*)packed;
+	if (!packed_pitch) {
+		packed_pitch = GBV_PACKED_PITCH;
+	}
+	/* unscaled 8 bit output gets a table of all 4 pixel combinations, everything else goes through the shades of a line */
+	gbv_u8 direct = output.format == OUTPUT_FORMAT_8 && output.scale == 1;
+	gbv_u8 colors4[256][4];
+	if (direct) {
+		for (gbv_u16 b = 0; b < 256; b++) {
+			for (gbv_u8 i = 0; i < 4; i++) {
+				colors4[b][i] = output.colors8[(b >> (6 - 2 * i)) & 0x03];
+			}
+		}
+	}
+	line_emitter emitter;
+	for (gbv_u8 lcd_y = 0; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		const gbv_u8 * row = src + packed_pitch * lcd_y;
+		if (direct) {
+			gbv_u8 * dst = get_output_row(&output, lcd_y);
+			for (gbv_u8 i = 0; i < GBV_PACKED_PITCH; i++) {
+				const gbv_u8 * colors = colors4[row[i]];
+				dst[4 * i]     = colors[0];
+				dst[4 * i + 1] = colors[1];
+				dst[4 * i + 2] = colors[2];
+				dst[4 * i + 3] = colors[3];
+			}
+		}
+		else {
+			gbv_u8 * shades = get_emitter_line(&emitter, lcd_y);
+			for (gbv_u8 i = 0; i < GBV_PACKED_PITCH; i++) {
+				shades[4 * i]     = row[i] >> 6;
+				shades[4 * i + 1] = (row[i] >> 4) & 0x03;
+				shades[4 * i + 2] = (row[i] >> 2) & 0x03;
+				shades[4 * i + 3] = row[i] & 0x03;
+			}
+			emit_line(&output, &emitter, lcd_y);
+		}
+	}
+}
+
+void gbv_set_tile_cache_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	state->tile_cache = (tile_cache_data*)memory;
+	if (state->tile_cache) {
+		fill_memory(state->tile_cache->dirty, sizeof(state->tile_cache->dirty), 0xFF);
+		state->caches_stale = 1;
+	}
+}
+
+void gbv_set_bg_layer_cache_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	state->bg_layers = (bg_layer_data*)memory;
+	if (state->bg_layers) {
+		fill_memory(state->bg_layers->valid, sizeof(state->bg_layers->valid), 0);
+		state->caches_stale = 1;
+	}
+}
+
+void gbv_set_line_cache_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	state->line_cache = (line_cache_data*)memory;
+	if (state->line_cache) {
+		fill_memory(state->line_cache, sizeof(line_cache_data), 0);
+		state->caches_stale = 1;
+	}
+}
+
+int gbv_get_line_cache_stats_ctx(gbv_context * ctx, gbv_line_cache_stats * stats) {
+	gbv_state * state = get_state(ctx);
+	if (!state->line_cache) {
+		*stats = {};
+		return 0;
+	}
+	*stats = state->line_cache->stats;
+	return 1;
+}
+
+void gbv_set_band_rendering_ctx(gbv_context * ctx, void * memory, int band_count, gbv_parallel_for parallel_for, void * user_data) {
+	gbv_state * state = get_state(ctx);
+	if (!memory || !parallel_for || band_count < 1) {
+		state->bands = 0;
+		return;
+	}
+	state->bands = (band_memory*)memory;
+	state->band_count = (gbv_u8)GBV_MIN(band_count, GBV_SCREEN_HEIGHT);
+	state->parallel_for = parallel_for;
+	state->parallel_for_user_data = user_data;
+}
+
+void gbv_set_line_sink_ctx(gbv_context * ctx, gbv_line_sink sink, void * user_data) {
+	gbv_state * state = get_state(ctx);
+	state->line_sink = sink;
+	state->line_sink_user_data = user_data;
+}
+
+void gbv_set_retained_frame_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	state->retained = (gbv_u8*)memory;
+	state->retained_valid = 0;
+}
+
+int gbv_recolor_ctx(gbv_context * ctx, const gbv_render_target * target) {
+	gbv_state * state = get_state(ctx);
+	if (!state->retained_valid) {
+		return 0;
+	}
+	render_output output = get_render_output(target);
+	output.sink = state->line_sink;
+	output.sink_user_data = state->line_sink_user_data;
+	tag_palette palette;
+	build_tag_palette(&ctx->io, &palette);
+	line_emitter emitter;
+	for (gbv_u8 lcd_y = 0; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		remap_bytes(palette.shades, state->retained + GBV_SCREEN_WIDTH * lcd_y, get_emitter_line(&emitter, lcd_y), GBV_SCREEN_WIDTH);
+		emit_line(&output, &emitter, lcd_y);
+	}
+	if (state->damage) {
+		/* the shades of the buffer are no longer known */
+		state->damage->valid = 0;
+		state->damage->full = 1;
+	}
+	return 1;
+}
+
+void gbv_set_damage_tracking_ctx(gbv_context * ctx, void * memory) {
+	gbv_state * state = get_state(ctx);
+	state->damage = (damage_data*)memory;
+	state->frame.damage = 0;
+	if (state->damage) {
+		fill_memory(state->damage, sizeof(damage_data), 0);
+	}
+}
+
+int gbv_get_damage_ctx(gbv_context * ctx, gbv_damage_rect * rects, int max_rects) {
+	gbv_state * state = get_state(ctx);
+	damage_data * damage = state->damage;
+	if (!damage) {
+		return -1;
+	}
+	if (max_rects < 1) {
+		return 0;
+	}
+	if (damage->full) {
+		rects[0] = { 0, 0, GBV_SCREEN_WIDTH, GBV_SCREEN_HEIGHT };
+		return 1;
+	}
+	/* epx output of a pixel depends on its neighbours */
+	gbv_u8 grow = damage->epx ? 1 : 0;
+	int count = 0;
+	gbv_u8 lcd_y = 0;
+	while (lcd_y < GBV_SCREEN_HEIGHT) {
+		if (!damage->x_end[lcd_y]) {
+			lcd_y++;
+			continue;
+		}
+		gbv_u8 first_line = lcd_y;
+		gbv_u8 x_first = GBV_SCREEN_WIDTH;
+		gbv_u8 x_end = 0;
+		while (lcd_y < GBV_SCREEN_HEIGHT && damage->x_end[lcd_y]) {
+			x_first = GBV_MIN(x_first, damage->x_first[lcd_y]);
+			x_end = GBV_MAX(x_end, damage->x_end[lcd_y]);
+			lcd_y++;
+		}
+		gbv_u8 x0 = (x_first > grow) ? x_first - grow : 0;
+		gbv_u8 y0 = (first_line > grow) ? first_line - grow : 0;
+		gbv_u8 x1 = GBV_MIN(x_end + grow, GBV_SCREEN_WIDTH);
+		gbv_u8 y1 = GBV_MIN(lcd_y + grow, GBV_SCREEN_HEIGHT);
+		if (count == max_rects) {
+			/* out of rects, the last one covers the rest */
+			gbv_damage_rect * last = rects + count - 1;
+			gbv_u8 last_x1 = last->x + last->width;
+			last->x = GBV_MIN(last->x, x0);
+			last->width = GBV_MAX(last_x1, x1) - last->x;
+			last->height = y1 - last->y;
+			continue;
+		}
+		rects[count++] = { x0, y0, (gbv_u8)(x1 - x0), (gbv_u8)(y1 - y0) };
+	}
+	return count;
+}
+
+void gbv_start_trace_ctx(gbv_context * ctx, void * memory, gbv_trace_write write, void * user_data) {
+	gbv_state * state = get_state(ctx);
+	if (state->trace) {
+		gbv_stop_trace_ctx(ctx);
+	}
+	if (!memory || !write) {
+		return;
+	}
+	state->trace = (trace_memory*)memory;
+	state->trace_write = write;
+	state->trace_user_data = user_data;
+	state->trace->used = 0;
+	/* the first frame starts from the complete state */
+	state->trace->full = 1;
+	gbv_u8 header[8] = { 'G', 'B', 'V', 'T', TRACE_VERSION, 0, 0, 0 };
+	trace_put(state, header, 8);
+}
+
+void gbv_stop_trace_ctx(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	if (state->trace) {
+		trace_flush(state);
+		state->trace = 0;
+	}
+}
+
+int gbv_trace_player_init(gbv_trace_player * player, const void * data, int size) {
+	const gbv_u8 * header = (const gbv_u8*)data;
+	player->data = data;
+	player->size = size;
+	player->pos = 0;
+	if (size < 8 || header[0] != 'G' || header[1] != 'B' || header[2] != 'V' || header[3] != 'T' || header[4] != TRACE_VERSION) {
+		player->size = 0;
+		return 0;
+	}
+	player->pos = 8;
+	return 1;
+}
+
+int gbv_play_trace_frame_ctx(gbv_context * ctx, gbv_trace_player * player, const gbv_render_target * target) {
+	gbv_state * state = get_state(ctx);
+	const gbv_u8 * data = (const gbv_u8*)player->data;
+	if (player->pos + 2 > player->size || data[player->pos] != TRACE_RECORD_FRAME) {
+		return 0;
+	}
+	gbv_u8 has_callback = data[player->pos + 1] & 1;
+	player->pos += 2;
+	if (!play_trace_deltas(ctx, player)) {
+		player->pos = player->size;
+		return 0;
+	}
+
+	/* the recorded callbacks replace the one of the caller */
+	gbv_ctx_int_callback callback = state->lcdc_int_callback;
+	void * callback_user_data = state->lcdc_int_user_data;
+	state->lcdc_int_callback = has_callback ? play_trace_callback : 0;
+	state->lcdc_int_user_data = player;
+	gbv_render_to_ctx(ctx, target);
+	state->lcdc_int_callback = callback;
+	state->lcdc_int_user_data = callback_user_data;
+	return 1;
+}
+
+int gbv_render_every_ctx(gbv_context * ctx, const gbv_render_target * target, int n) {
+	gbv_state * state = get_state(ctx);
+	gbv_u8 draw = n <= 1 || state->render_every_count % n == 0;
+	state->render_every_count = draw ? 1 : state->render_every_count + 1;
+	gbv_render_to_ctx(ctx, draw ? target : 0);
+	return draw;
+}
+
+int gbv_get_stats_ctx(gbv_context * ctx, gbv_stats * stats) {
+#ifdef GBV_STATS
+	*stats = get_state(ctx)->stats;
+	return 1;
+#else
+	(void)ctx;
+	*stats = {};
+	return 0;
+#endif
+}
+
+void gbv_transfer_oam_data_ctx(gbv_context * ctx, gbv_obj_char objs[GBV_OBJ_COUNT]) {
+	gbv_state * state = get_state(ctx);
+	for (int i = 0; i < GBV_OBJ_COUNT; i++) {
+		state->oam_data[i] = objs[i];
+	}
+	set_bits(state->dirty.oam, 0, GBV_OBJ_COUNT);
+	state->write_serial++;
+	build_oam_index(ctx, ctx->io.lcdc & GBV_LCDC_OBJ_SIZE_SELECT);
+}
+
+/* global API, forwards to global_ctx and keeps its registers in sync with the gbv_io_* globals */
+static void global_regs_load() {
+	global_ctx.io.lcdc = gbv_io_lcdc;
+	global_ctx.io.bgp  = gbv_io_bgp;
+	global_ctx.io.obp0 = gbv_io_obp0;
+	global_ctx.io.obp1 = gbv_io_obp1;
+	global_ctx.io.scx  = gbv_io_scx;
+	global_ctx.io.scy  = gbv_io_scy;
+	global_ctx.io.lyc  = gbv_io_lyc;
+	global_ctx.io.wx   = gbv_io_wx;
+	global_ctx.io.wy   = gbv_io_wy;
+}
+
+static void global_regs_store() {
+	gbv_io_lcdc = global_ctx.io.lcdc;
+	gbv_io_bgp  = global_ctx.io.bgp;
+	gbv_io_obp0 = global_ctx.io.obp0;
+	gbv_io_obp1 = global_ctx.io.obp1;
+	gbv_io_scx  = global_ctx.io.scx;
+	gbv_io_scy  = global_ctx.io.scy;
+	gbv_io_lyc  = global_ctx.io.lyc;
+	gbv_io_wx   = global_ctx.io.wx;
+	gbv_io_wy   = global_ctx.io.wy;
+}
+
+/* callbacks of the global API see and modify the globals */
+static void global_int_callback_wrapper(gbv_context * ctx, void * user_data) {
+	(void)ctx;
+	(void)user_data;
+	global_regs_store();
+	global_int_callback();
+	global_regs_load();
+}
+
+void gbv_init(void * memory) {
+	/* settings made before gbv_init are kept */
+	gbv_state * state = get_state(&global_ctx);
+	gbv_io io_stat = state->io_stat;
+	tile_cache_data * tile_cache = state->tile_cache;
+	bg_layer_data * bg_layers = state->bg_layers;
+	line_cache_data * line_cache = state->line_cache;
+	band_memory * bands = state->bands;
+	gbv_u8 band_count = state->band_count;
+	gbv_parallel_for parallel_for = state->parallel_for;
+	void * parallel_for_user_data = state->parallel_for_user_data;
+	gbv_line_sink line_sink = state->line_sink;
+	void * line_sink_user_data = state->line_sink_user_data;
+	gbv_u8 * retained = state->retained;
+	damage_data * damage = state->damage;
+	trace_memory * trace = state->trace;
+	gbv_trace_write trace_write = state->trace_write;
+	void * trace_user_data = state->trace_user_data;
+	gbv_init_ctx(&global_ctx, memory);
+	global_regs_load();
+	gbv_stat_set_ctx(&global_ctx, (gbv_stat_flag)io_stat);
+	gbv_set_tile_cache_ctx(&global_ctx, tile_cache);
+	gbv_set_bg_layer_cache_ctx(&global_ctx, bg_layers);
+	gbv_set_line_cache_ctx(&global_ctx, line_cache);
+	gbv_set_band_rendering_ctx(&global_ctx, bands, band_count, parallel_for, parallel_for_user_data);
+	gbv_set_line_sink_ctx(&global_ctx, line_sink, line_sink_user_data);
+	gbv_set_retained_frame_ctx(&global_ctx, retained);
+	gbv_set_damage_tracking_ctx(&global_ctx, damage);
+	if (trace) {
+		/* the trace goes on, its next frame starts from the complete state of the new memory */
+		state->trace = trace;
+		state->trace_write = trace_write;
+		state->trace_user_data = trace_user_data;
+		trace->full = 1;
+	}
+	if (global_int_callback) {
+		gbv_lcdc_set_stat_interrupt_ctx(&global_ctx, global_int_callback_wrapper, 0);
+	}
+}
+
+void gbv_lcdc_set(gbv_lcdc_flag flag) {
+	gbv_io_lcdc = gbv_io_lcdc | flag;
+}
+
+void gbv_lcdc_reset(gbv_lcdc_flag flag) {
+	gbv_io_lcdc = gbv_io_lcdc & ~flag;
+}
+
+void gbv_stat_set(gbv_stat_flag flag) {
+	gbv_stat_set_ctx(&global_ctx, flag);
+}
+
+void gbv_stat_reset(gbv_stat_flag flag) {
+	gbv_stat_reset_ctx(&global_ctx, flag);
+}
+
+gbv_lcd_mode gbv_stat_mode() {
+	return gbv_stat_mode_ctx(&global_ctx);
+}
+
+gbv_u8 gbv_stat_lyc() {
+	return gbv_stat_lyc_ctx(&global_ctx);
+}
+
+gbv_io gbv_ly() {
+	return gbv_ly_ctx(&global_ctx);
+}
+
+gbv_u8 * gbv_get_rom_data() {
+	return gbv_get_rom_data_ctx(&global_ctx);
+}
+
+gbv_u8 * gbv_get_tile_map0() {
+	return gbv_get_tile_map0_ctx(&global_ctx);
+}
+
+gbv_u8 * gbv_get_tile_map1() {
+	return gbv_get_tile_map1_ctx(&global_ctx);
+}
+
+gbv_u8 * gbv_get_tile_data() {
+	return gbv_get_tile_data_ctx(&global_ctx);
+}
+
+gbv_tile * gbv_get_tile(gbv_u8 tile_id) {
+	return gbv_get_tile_ctx(&global_ctx, tile_id);
+}
+
+int gbv_write_vram(int address, const void * src, int length) {
+	return gbv_write_vram_ctx(&global_ctx, address, src, length);
+}
+
+void gbv_write8(int address, gbv_u8 value) {
+	gbv_write8_ctx(&global_ctx, address, value);
+}
+
+int gbv_get_dirty(gbv_dirty_regions * dirty) {
+	return gbv_get_dirty_ctx(&global_ctx, dirty);
+}
+
+void gbv_clear_dirty() {
+	gbv_clear_dirty_ctx(&global_ctx);
+}
+
+void gbv_mark_all_dirty() {
+	gbv_mark_all_dirty_ctx(&global_ctx);
+}
+
+void gbv_lcdc_set_stat_interrupt(gbv_int_callback callback) {
+	global_int_callback = callback;
+	gbv_lcdc_set_stat_interrupt_ctx(&global_ctx, callback ? global_int_callback_wrapper : 0, 0);
+}
+
+void gbv_set_tile_cache(void * memory) {
+	gbv_set_tile_cache_ctx(&global_ctx, memory);
+}
+
+void gbv_set_bg_layer_cache(void * memory) {
+	gbv_set_bg_layer_cache_ctx(&global_ctx, memory);
+}
+
+void gbv_set_line_cache(void * memory) {
+	gbv_set_line_cache_ctx(&global_ctx, memory);
+}
+
+int gbv_get_line_cache_stats(gbv_line_cache_stats * stats) {
+	return gbv_get_line_cache_stats_ctx(&global_ctx, stats);
+}
+
+void gbv_set_band_rendering(void * memory, int band_count, gbv_parallel_for parallel_for, void * user_data) {
+	gbv_set_band_rendering_ctx(&global_ctx, memory, band_count, parallel_for, user_data);
+}
+
+void gbv_set_line_sink(gbv_line_sink sink, void * user_data) {
+	gbv_set_line_sink_ctx(&global_ctx, sink, user_data);
+}
+
+void gbv_set_retained_frame(void * memory) {
+	gbv_set_retained_frame_ctx(&global_ctx, memory);
+}
+
+int gbv_recolor(const gbv_render_target * target) {
+	global_regs_load();
+	return gbv_recolor_ctx(&global_ctx, target);
+}
+
+void gbv_set_damage_tracking(void * memory) {
+	gbv_set_damage_tracking_ctx(&global_ctx, memory);
+}
+
+int gbv_get_damage(gbv_damage_rect * rects, int max_rects) {
+	return gbv_get_damage_ctx(&global_ctx, rects, max_rects);
+}
+
+void gbv_start_trace(void * memory, gbv_trace_write write, void * user_data) {
+	global_regs_load();
+	gbv_start_trace_ctx(&global_ctx, memory, write, user_data);
+}
+
+void gbv_stop_trace() {
+	gbv_stop_trace_ctx(&global_ctx);
+}
+
+int gbv_play_trace_frame(gbv_trace_player * player, const gbv_render_target * target) {
+	global_regs_load();
+	int played = gbv_play_trace_frame_ctx(&global_ctx, player, target);
+	global_regs_store();
+	return played;
+}
+
+int gbv_render_every(const gbv_render_target * target, int n) {
+	global_regs_load();
+	int drawn = gbv_render_every_ctx(&global_ctx, target, n);
+	global_regs_store();
+	return drawn;
+}
+
+int gbv_get_stats(gbv_stats * stats) {
+	return gbv_get_stats_ctx(&global_ctx, stats);
+}
+
+void gbv_transfer_oam_data(gbv_obj_char objs[GBV_OBJ_COUNT]) {
+	global_regs_load();
+	gbv_transfer_oam_data_ctx(&global_ctx, objs);
+}
+
+void gbv_render(void * render_buffer, gbv_render_mode mode, gbv_palette * palette) {
+	global_regs_load();
+	gbv_render_ctx(&global_ctx, render_buffer, mode, palette);
+	global_regs_store();
+}
+
+void gbv_render_to(const gbv_render_target * target) {
+	global_regs_load();
+	gbv_render_to_ctx(&global_ctx, target);
+	global_regs_store();
+}
+
+void gbv_begin_frame(const gbv_render_target * target) {
+	global_regs_load();
+	gbv_begin_frame_ctx(&global_ctx, target);
+	global_regs_store();
+}
+
+int gbv_render_scanline(int ly) {
+	global_regs_load();
+	int result = gbv_render_scanline_ctx(&global_ctx, ly);
+	global_regs_store();
+	return result;
+}
+
+void gbv_end_frame() {
+	global_regs_load();
+	gbv_end_frame_ctx(&global_ctx);
+	global_regs_store();
+}
+
+int gbv_step(const gbv_render_target * target, int cycles) {
+	global_regs_load();
+	int frames = gbv_step_ctx(&global_ctx, target, cycles);
+	global_regs_store();
+	return frames;
+}
+
+int gbv_next_stat_event(int * ly, int * dot) {
+	global_regs_load();
+	return gbv_next_stat_event_ctx(&global_ctx, ly, dot);
+}
+
+void gbv_render_ctx(gbv_context * ctx, void * render_buffer, gbv_render_mode mode, gbv_palette * palette) {
+	gbv_render_target target = {};
+	target.buffer = render_buffer;
+	target.mode = mode;
+	target.palette = palette;
+	gbv_render_to_ctx(ctx, &target);
+}
+
+void gbv_begin_frame_ctx(gbv_context * ctx, const gbv_render_target * target) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	if (state->trace) {
+		trace_frame(ctx);
+	}
+#ifdef GBV_STATS
+	state->stats = {};
+#endif
+	gbv_render_target no_target = {};
+	frame->pixels = target && target->buffer;
+	frame->bands = frame->pixels && state->bands;
+	frame->output = get_render_output(frame->pixels ? target : &no_target);
+	frame->output.sink = state->line_sink;
+	frame->output.sink_user_data = state->line_sink_user_data;
+	frame->next_line = 0;
+	frame->first_pending = 0;
+	frame->recorded_end = 0;
+	frame->external_writes = 0;
+	frame->damage = 0;
+	frame->unchanged = 0;
+	frame->skip_lines = 0;
+	state->stat_trig = {};
+	state->caches_stale = 1;
+	state->oam_index_stale = 1;
+	if (state->line_cache) {
+		for (gbv_u8 i = 0; i < GBV_SCREEN_HEIGHT; i++) {
+			state->line_cache->lines[i].result = LINE_CACHE_NONE;
+		}
+	}
+	frame->active = (ctx->io.lcdc & GBV_LCDC_CTRL) != 0;
+	if (state->damage) {
+		/* frames without pixels don't touch the buffer */
+		fill_memory(state->damage->x_first, sizeof(state->damage->x_first), 0);
+		fill_memory(state->damage->x_end, sizeof(state->damage->x_end), 0);
+		state->damage->full = 0;
+		if (frame->active && frame->pixels) {
+			begin_damage_frame(ctx);
+		}
+	}
+	if (frame->active) {
+		/* the retained frame is overwritten line by line, or no longer shows the current frame */
+		state->retained_valid = 0;
+	}
+	if (frame->active && frame->bands) {
+		/* band rendering only records lines, they are rendered when video memory changes and at the end */
+		snapshot_vram(state);
+	}
+}
+
+static void set_ly(gbv_context * ctx, gbv_u8 ly) {
+	gbv_state * state = get_state(ctx);
+	state->io_ly = ly;
+	if (ctx->io.lyc == state->io_ly) {
+		state->io_stat = state->io_stat | GBV_STAT_LYC;
+	}
+	else {
+		state->io_stat = (state->io_stat & ~GBV_STAT_LYC);
+	}
+}
+
+/* mode 2 of a visible line: LY update, OAM interrupt and object selection */
+static void line_oam(gbv_context * ctx, gbv_u8 lcd_y) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	check_external_writes(state);
+	set_ly(ctx, lcd_y);
+
+	if (lcd_change_mode(ctx, GBV_LCD_MODE_OAM) && frame->bands) {
+		check_band_snapshot(state, &frame->first_pending, lcd_y, &frame->output);
+	}
+	if (!frame->pixels) {
+		/* the selected objects are only seen by the pixel transfer */
+		return;
+	}
+	if (frame->damage) {
+		check_damage_inputs(ctx, lcd_y);
+	}
+	GBV_STATS_TIMER(oam_start);
+	line_input * input = frame->bands ? state->bands->lines + lcd_y : &frame->input;
+	gbv_u8 * objs;
+	input->obj_count = search_oam(ctx, lcd_y, &objs);
+	for (gbv_u8 i = 0; i < input->obj_count; i++) {
+		input->objs[i] = objs[i];
+	}
+	GBV_STATS_TIME(state, oam_search_ticks, oam_start);
+	GBV_STATS_ADD(state, objects, input->obj_count);
+	GBV_STATS_MAX(state, max_objects_per_line, input->obj_count);
+	GBV_STATS_ADD(state, lines_at_object_limit, input->obj_count == MAX_OBJECTS_PER_SCANLINE);
+}
+
+/* mode 3: LYC interrupt and pixel transfer, band rendering only records the registers */
+static void line_transfer(gbv_context * ctx, gbv_u8 lcd_y) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	check_external_writes(state);
+	if (lcd_change_mode(ctx, GBV_LCD_MODE_TRANSFER) && frame->bands) {
+		check_band_snapshot(state, &frame->first_pending, lcd_y, &frame->output);
+	}
+	if (!frame->pixels) {
+		return;
+	}
+	if (frame->damage) {
+		check_damage_inputs(ctx, lcd_y);
+		if (frame->unchanged && lcd_y < frame->skip_lines) {
+			/* the line is still in the buffer from the previous frame */
+			if (frame->bands) {
+				frame->first_pending = lcd_y + 1;
+				frame->recorded_end = lcd_y + 1;
+			}
+			return;
+		}
+	}
+	line_input * input = frame->bands ? state->bands->lines + lcd_y : &frame->input;
+	input->io = ctx->io;
+	frame->recorded_end = lcd_y + 1;
+	GBV_STATS_ADD(state, lines, 1);
+	GBV_STATS_ADD(state, window_pixels, GBV_SCREEN_WIDTH - get_window_start(&input->io, lcd_y));
+	GBV_STATS_TIMER(transfer_start);
+	/* with band rendering the caches follow the snapshot, which is synced whenever it is taken */
+	vram_view live = get_live_view(state);
+	if (!frame->bands && state->caches_stale) {
+		sync_caches(state, &live);
+	}
+	if (state->bg_layers) {
+		prepare_bg_layers(state->bg_layers, &input->io, lcd_y);
+	}
+	if (!frame->bands) {
+		gbv_u8 * tags = state->retained ? state->retained + GBV_SCREEN_WIDTH * lcd_y : 0;
+		render_line(&live, input, lcd_y, get_emitter_line(&frame->emitter, lcd_y), tags);
+		emit_line(&frame->output, &frame->emitter, lcd_y);
+		GBV_STATS_TIME(state, transfer_ticks, transfer_start);
+	}
+}
+
+/* mode 0 */
+static void line_hblank(gbv_context * ctx, gbv_u8 lcd_y) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	if (lcd_change_mode(ctx, GBV_LCD_MODE_HBLANK) && frame->bands) {
+		check_band_snapshot(state, &frame->first_pending, lcd_y + 1, &frame->output);
+	}
+	frame->next_line = lcd_y + 1;
+}
+
+/* bg and window palette indices of lines first_line to the end of the frame, the bg of all lines before the window */
+template <gbv_u8 signed_ids>
+static void draw_tile_layers(const vram_view * vram, const gbv_io_regs * io, gbv_u8 first_line, gbv_u8 * pixels) {
+	gbv_u8 bg_map = (io->lcdc & GBV_LCDC_BG_MAP_SELECT) ? 1 : 0;
+	gbv_u8 wnd_map = (io->lcdc & GBV_LCDC_WND_MAP_SELECT) ? 1 : 0;
+	for (gbv_u8 lcd_y = first_line; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		gbv_u8 * line = pixels + GBV_SCREEN_WIDTH * lcd_y;
+		gbv_u8 wnd_start = get_window_start(io, lcd_y);
+		if (io->lcdc & GBV_LCDC_BG_ENABLE) {
+			fetch_tile_span<signed_ids>(vram, bg_map, line, io->scx, lcd_y + io->scy, wnd_start);
+		}
+		else {
+			memset(line, 0, wnd_start);
+		}
+	}
+	for (gbv_u8 lcd_y = GBV_MAX(first_line, io->wy); lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		gbv_u8 * line = pixels + GBV_SCREEN_WIDTH * lcd_y;
+		gbv_u8 wnd_start = get_window_start(io, lcd_y);
+		if (wnd_start < GBV_SCREEN_WIDTH) {
+			/* window starts at WX - 7 */
+			fetch_tile_span<signed_ids>(vram, wnd_map, line + wnd_start, wnd_start + 7 - io->wx, lcd_y - io->wy, GBV_SCREEN_WIDTH - wnd_start);
+		}
+	}
+}
+
+/*
+  whole frames are drawn a layer at a time when nothing can change the registers or video memory between lines:
+  no STAT callback, no band rendering or line cache and no line of the frame rendered yet
+*/
+static gbv_u8 can_render_layers(const gbv_state * state) {
+	const frame_state * frame = &state->frame;
+	return frame->active && frame->pixels && frame->next_line == 0 && !state->lcdc_int_callback && !frame->bands && !state->line_cache;
+}
+
+/*
+  layer at a time rendering of a frame, the same pixels as render_line for every line
+    - bg of all lines, then the window, then the objects of every line on top, then one palette remap of the frame
+    - LY, STAT modes and the selected objects still advance line by line, only nothing can see them in between
+*/
+static void render_frame_layers(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	const gbv_io_regs io = ctx->io;
+	gbv_u8 * objs[GBV_SCREEN_HEIGHT];
+	gbv_u8 obj_counts[GBV_SCREEN_HEIGHT];
+	check_external_writes(state);
+	if (frame->damage) {
+		check_damage_inputs(ctx, 0);
+	}
+	for (gbv_u8 lcd_y = 0; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		set_ly(ctx, lcd_y);
+		lcd_change_mode(ctx, GBV_LCD_MODE_OAM);
+		GBV_STATS_TIMER(oam_start);
+		obj_counts[lcd_y] = search_oam(ctx, lcd_y, objs + lcd_y);
+		GBV_STATS_TIME(state, oam_search_ticks, oam_start);
+		GBV_STATS_ADD(state, objects, obj_counts[lcd_y]);
+		GBV_STATS_MAX(state, max_objects_per_line, obj_counts[lcd_y]);
+		GBV_STATS_ADD(state, lines_at_object_limit, obj_counts[lcd_y] == MAX_OBJECTS_PER_SCANLINE);
+		lcd_change_mode(ctx, GBV_LCD_MODE_TRANSFER);
+		lcd_change_mode(ctx, GBV_LCD_MODE_HBLANK);
+	}
+	frame->next_line = GBV_SCREEN_HEIGHT;
+
+	/* with damage tracking, the lines of an unchanged frame are kept like in line_transfer */
+	gbv_u8 first_line = (frame->damage && frame->unchanged) ? frame->skip_lines : 0;
+	if (first_line >= GBV_SCREEN_HEIGHT) {
+		return;
+	}
+	GBV_STATS_TIMER(transfer_start);
+	vram_view live = get_live_view(state);
+	if (state->caches_stale) {
+		sync_caches(state, &live);
+	}
+	if (state->bg_layers) {
+		/* the window is visible on the last line if it is visible on any */
+		prepare_bg_layers(state->bg_layers, &io, GBV_SCREEN_HEIGHT - 1);
+	}
+
+	/* palette indices of bg and window first, tagged in place, then remapped in place unless the tags are retained */
+	gbv_u8 shades[GBV_SCREEN_SIZE];
+	gbv_u8 * tags = state->retained ? state->retained : shades;
+	if (io.lcdc & GBV_LCDC_BG_DATA_SELECT) {
+		draw_tile_layers<1>(&live, &io, first_line, tags);
+	}
+	else {
+		draw_tile_layers<0>(&live, &io, first_line, tags);
+	}
+	for (gbv_u8 lcd_y = first_line; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		/* disabled bg is not mapped through bgp, the window always is */
+		gbv_u8 layer_start = (io.lcdc & GBV_LCDC_BG_ENABLE) ? 0 : get_window_start(&io, lcd_y);
+		or_memory(tags + GBV_SCREEN_WIDTH * lcd_y + layer_start, GBV_SCREEN_WIDTH - layer_start, PIXEL_TAG_BGP);
+		GBV_STATS_ADD(state, lines, 1);
+		GBV_STATS_ADD(state, window_pixels, GBV_SCREEN_WIDTH - get_window_start(&io, lcd_y));
+	}
+	if (io.lcdc & GBV_LCDC_OBJ_ENABLE) {
+		line_input input;
+		input.io = io;
+		for (gbv_u8 lcd_y = first_line; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+			if (!obj_counts[lcd_y]) {
+				continue;
+			}
+			/* only the pixels the objects of the line cover are composed */
+			int x_min = GBV_SCREEN_WIDTH;
+			int x_max = 0;
+			input.obj_count = obj_counts[lcd_y];
+			for (gbv_u8 i = 0; i < input.obj_count; i++) {
+				input.objs[i] = objs[lcd_y][i];
+				gbv_obj_char * obj = live.oam_data + input.objs[i];
+				x_min = GBV_MIN(x_min, obj->x - GBV_SPRITE_MARGIN_LEFT);
+				x_max = GBV_MAX(x_max, obj->x);
+			}
+			x_min = GBV_MAX(x_min, 0);
+			x_max = GBV_MIN(x_max, GBV_SCREEN_WIDTH);
+			if (x_min >= x_max) {
+				continue;
+			}
+			gbv_u8 obj_line[GBV_SCREEN_WIDTH];
+			memset(obj_line + x_min, 0, x_max - x_min);
+			fetch_obj_line(&live, &input, obj_line, lcd_y);
+			gbv_u8 * line = tags + GBV_SCREEN_WIDTH * lcd_y;
+			for (int i = x_min; i < x_max; i++) {
+				gbv_u8 obj = obj_line[i];
+				if (obj && (!(obj & GBV_OBJ_ATTR_PRIORITY_FLAG) || !(line[i] & 0x03))) {
+					line[i] = get_obj_tag(obj);
+				}
+			}
+		}
+	}
+	tag_palette palette;
+	build_tag_palette(&io, &palette);
+	gbv_u16 offset = GBV_SCREEN_WIDTH * first_line;
+	remap_bytes(palette.shades, tags + offset, shades + offset, GBV_SCREEN_SIZE - offset);
+
+	const render_output * output = &frame->output;
+	for (gbv_u8 lcd_y = first_line; lcd_y < GBV_SCREEN_HEIGHT; lcd_y++) {
+		const gbv_u8 * line = shades + GBV_SCREEN_WIDTH * lcd_y;
+		if (live.damage) {
+			track_line_damage(live.damage, lcd_y, line);
+		}
+		if (output->epx) {
+			const gbv_u8 * above = (lcd_y > 0) ? line - GBV_SCREEN_WIDTH : line;
+			const gbv_u8 * below = (lcd_y < GBV_SCREEN_HEIGHT - 1) ? line + GBV_SCREEN_WIDTH : line;
+			write_line_epx(output, lcd_y, above, line, below);
+		}
+		else {
+			write_line(output, lcd_y, line);
+		}
+		notify_lines(output, lcd_y, lcd_y + 1);
+	}
+	GBV_STATS_TIME(state, transfer_ticks, transfer_start);
+}
+
+static void render_scanline(gbv_context * ctx, gbv_u8 lcd_y) {
+	line_oam(ctx, lcd_y);
+	line_transfer(ctx, lcd_y);
+	line_hblank(ctx, lcd_y);
+}
+
+int gbv_render_scanline_ctx(gbv_context * ctx, int ly) {
+	frame_state * frame = &get_state(ctx)->frame;
+	if (!frame->active || ly != frame->next_line) {
+		return 0;
+	}
+	frame->external_writes = 1;
+	render_scanline(ctx, (gbv_u8)ly);
+	return 1;
+}
+
+static void end_frame(gbv_context * ctx) {
+	gbv_state * state = get_state(ctx);
+	frame_state * frame = &state->frame;
+	if (!frame->active) {
+		return;
+	}
+	if (can_render_layers(state)) {
+		render_frame_layers(ctx);
+	}
+	while (frame->next_line < GBV_SCREEN_HEIGHT) {
+		render_scanline(ctx, frame->next_line);
+	}
+	if (frame->bands) {
+		check_external_writes(state);
+		flush_bands(state, frame->first_pending, GBV_SCREEN_HEIGHT, &frame->output);
+	}
+	frame->active = 0;
+	state->retained_valid = state->retained && frame->pixels;
+	if (frame->damage) {
+		state->damage->valid = 1;
+		frame->damage = 0;
+	}
+	if (state->line_cache) {
+		count_line_cache_results(state->line_cache);
+	}
+	lcd_change_mode(ctx, GBV_LCD_MODE_VBLANK);
+}
+
+void gbv_end_frame_ctx(gbv_context * ctx) {
+	get_state(ctx)->frame.external_writes = 1;
+	end_frame(ctx);
+}
+
+/* mode boundaries of a line in dots, v-blank lines only have the first and the last one */
+static const gbv_u16 line_event_dots[] = {
+	0,
+	GBV_DOTS_OAM,
+	GBV_DOTS_OAM + GBV_DOTS_TRANSFER,
+	GBV_DOTS_PER_LINE,
+};
+
+int gbv_step_ctx(gbv_context * ctx, const gbv_render_target * target, int cycles) {
+	gbv_state * state = get_state(ctx);
+	step_state * step = &state->step;
+	int frames = 0;
+	if (cycles < 0) {
+		cycles = 0;
+	}
+	state->frame.external_writes = 1;
+	for (;;) {
+		/* jump to the next mode boundary */
+		gbv_u16 event_dot = line_event_dots[step->event];
+		if (event_dot - step->dot > cycles) {
+			step->dot += cycles;
+			break;
+		}
+		cycles -= event_dot - step->dot;
+		step->dot = event_dot;
+
+		if (step->ly < GBV_SCREEN_HEIGHT) {
+			switch (step->event) {
+			case 0:
+				if (step->ly == 0) {
+					if (!(ctx->io.lcdc & GBV_LCDC_CTRL)) {
+						/* lcd is off, wait at the start of the frame until it is turned on, the frame begins once it is */
+						return frames;
+					}
+					gbv_begin_frame_ctx(ctx, target);
+				}
+				line_oam(ctx, step->ly);
+				break;
+			case 1:
+				line_transfer(ctx, step->ly);
+				break;
+			case 2:
+				line_hblank(ctx, step->ly);
+				break;
+			}
+		}
+		else if (step->event == 0) {
+			set_ly(ctx, step->ly);
+			if (step->ly == GBV_SCREEN_HEIGHT) {
+				end_frame(ctx);
+				frames++;
+			}
+		}
+
+		if (step->event == 3) {
+			step->ly = (step->ly + 1) % GBV_LINES_PER_FRAME;
+			step->dot = 0;
+			step->event = 0;
+		}
+		else {
+			step->event = (step->ly < GBV_SCREEN_HEIGHT) ? step->event + 1 : 3;
+		}
+	}
+	return frames;
+}
+
+/* first dot at or after from where an event repeating every period dots in lines first_line to end_line happens */
+static int find_line_event(int from, int first_line, int end_line, int dot) {
+	int line = GBV_MAX(first_line, (from - dot + GBV_DOTS_PER_LINE - 1) / GBV_DOTS_PER_LINE);
+	if (line >= end_line) {
+		line = first_line + GBV_LINES_PER_FRAME;
+	}
+	return GBV_DOTS_PER_LINE * line + dot;
+}
+
+int gbv_next_stat_event_ctx(gbv_context * ctx, int * ly, int * dot) {
+	gbv_state * state = get_state(ctx);
+	step_state * step = &state->step;
+	/* dot of the frame at which the clock is and of the next boundary it hasn't processed yet */
+	int now = GBV_DOTS_PER_LINE * step->ly + step->dot;
+	int from = GBV_DOTS_PER_LINE * step->ly + line_event_dots[step->event];
+	/* with the lcd off, the clock stops at the start of the next frame */
+	int lcd_on = ctx->io.lcdc & GBV_LCDC_CTRL;
+	int frame_end = (from > 0) ? GBV_DOTS_PER_FRAME : 0;
+
+	int event = -1;
+	gbv_u8 sources = state->io_stat;
+	if (sources & GBV_STAT_OAM_INT) {
+		int next = find_line_event(from, 0, GBV_SCREEN_HEIGHT, 0);
+		event = (event < 0 || next < event) ? next : event;
+	}
+	if (sources & GBV_STAT_HBLANK_INT) {
+		int next = find_line_event(from, 0, GBV_SCREEN_HEIGHT, GBV_DOTS_OAM + GBV_DOTS_TRANSFER);
+		event = (event < 0 || next < event) ? next : event;
+	}
+	if (sources & GBV_STAT_VBLANK_INT) {
+		int next = find_line_event(from, GBV_SCREEN_HEIGHT, GBV_SCREEN_HEIGHT + 1, 0);
+		event = (event < 0 || next < event) ? next : event;
+	}
+	if ((sources & GBV_STAT_LYC_INT) && ctx->io.lyc < GBV_SCREEN_HEIGHT) {
+		int next = find_line_event(from, ctx->io.lyc, ctx->io.lyc + 1, GBV_DOTS_OAM);
+		event = (event < 0 || next < event) ? next : event;
+	}
+	if (event < 0 || (!lcd_on && event >= frame_end)) {
+		return -1;
+	}
+	if (ly) {
+		*ly = (event / GBV_DOTS_PER_LINE) % GBV_LINES_PER_FRAME;
+	}
+	if (dot) {
+		*dot = event % GBV_DOTS_PER_LINE;
+	}
+	return event - now;
+}
+
+void gbv_render_to_ctx(gbv_context * ctx, const gbv_render_target * target) {
+	gbv_begin_frame_ctx(ctx, target);
+	end_frame(ctx);
 }
-#endif
\ No newline at end of file
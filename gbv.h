@@ -15,6 +15,18 @@
 #define GBV_SCREEN_HEIGHT      144
 #define GBV_SCREEN_SIZE        (GBV_SCREEN_WIDTH * GBV_SCREEN_HEIGHT)
 
+/* GBV_RENDER_MODE_PACKED_2 frame, 4 pixels per byte */
+#define GBV_PACKED_PITCH       (GBV_SCREEN_WIDTH / 4)
+#define GBV_PACKED_SIZE        (GBV_PACKED_PITCH * GBV_SCREEN_HEIGHT)
+
+/* timing in dots (4.194304 MHz), a line takes 456 dots, a frame 144 visible and 10 v-blank lines */
+#define GBV_DOTS_OAM           80
+#define GBV_DOTS_TRANSFER      172
+#define GBV_DOTS_HBLANK        204
+#define GBV_DOTS_PER_LINE      (GBV_DOTS_OAM + GBV_DOTS_TRANSFER + GBV_DOTS_HBLANK)
+#define GBV_LINES_PER_FRAME    154
+#define GBV_DOTS_PER_FRAME     (GBV_DOTS_PER_LINE * GBV_LINES_PER_FRAME)
+
 #define GBV_BG_TILES_X         32
 #define GBV_BG_TILES_Y         32
 #define GBV_BG_TILE_COUNT      (GBV_BG_TILES_X * GBV_BG_TILES_Y)
@@ -28,24 +40,91 @@
 #define GBV_TILE_PITCH         2
 #define GBV_TILE_SIZE          (GBV_TILE_PITCH * GBV_TILE_HEIGHT)
 
+#define GBV_TILE_COUNT         (GBV_TILE_MEMORY_SIZE / GBV_TILE_SIZE)
+#define GBV_TILE_PIXELS        (GBV_TILE_WIDTH * GBV_TILE_HEIGHT)
+
+/* raw shadow copy, decoded tiles, x-flipped decoded tiles and dirty bits */
+#define GBV_TILE_CACHE_SIZE    (GBV_TILE_MEMORY_SIZE + 2 * GBV_TILE_COUNT * GBV_TILE_PIXELS + GBV_TILE_COUNT / 8)
+
+/* 256x256 palette indices of a whole tile map */
+#define GBV_BG_LAYER_SIZE      (GBV_BG_TILES_X * GBV_TILE_WIDTH * GBV_BG_TILES_Y * GBV_TILE_HEIGHT)
+
+/* a layer for each tile map and tile data select, raw shadow copies of tile data and tile maps, valid flags */
+#define GBV_BG_LAYER_CACHE_SIZE (4 * GBV_BG_LAYER_SIZE + GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE + 8)
+
+/* pixel tags and input hash of every scanline, shadow copy of tile data, generation of every tile and counters */
+#define GBV_LINE_CACHE_SIZE    (GBV_SCREEN_HEIGHT * (GBV_SCREEN_WIDTH + 16) + GBV_TILE_MEMORY_SIZE + 4 * GBV_TILE_COUNT + 32)
+
 #define GBV_OBJ_COUNT          40
 #define GBV_OBJ_SIZE           (4 * GBV_OBJ_COUNT)
 
+#define GBV_CONTEXT_STATE_SIZE 4096
+
+/* video memory snapshot, 32 bytes of recorded state per scanline and the shades of a frame for epx scaling */
+#define GBV_BAND_MEMORY_SIZE   (GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE + GBV_OAM_MEMORY_SIZE + 32 * GBV_SCREEN_HEIGHT + GBV_SCREEN_SIZE)
+
+/* palette layer and index of every pixel of a frame */
+#define GBV_RETAINED_FRAME_SIZE GBV_SCREEN_SIZE
+
+/* shades of the last tracked frame, the video memory, OAM and registers it started from and per line extents */
+#define GBV_DAMAGE_MEMORY_SIZE (GBV_SCREEN_SIZE + GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE + GBV_OAM_MEMORY_SIZE + 2 * GBV_SCREEN_HEIGHT + 128)
+
+/* shadow copy of VRAM, OAM and registers plus 4k of output buffer */
+#define GBV_TRACE_MEMORY_SIZE  (GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE + GBV_OAM_MEMORY_SIZE + 16 + 4096)
+
 typedef char           gbv_s8;
 typedef short          gbv_s16;
 typedef unsigned char  gbv_u8;
 typedef unsigned short gbv_u16;
+typedef unsigned int   gbv_u32;
 
 typedef unsigned char  gbv_io;
 
+/* 32 bit modes store one native 32 bit word per pixel, channels are listed from the most significant byte */
 typedef enum {
 	GBV_RENDER_MODE_GRAYSCALE_8,	// 0-255
+	GBV_RENDER_MODE_RGBA8888,
+	GBV_RENDER_MODE_ARGB8888,
+	GBV_RENDER_MODE_ABGR8888,
+	GBV_RENDER_MODE_BGRA8888,
+	GBV_RENDER_MODE_XRGB8888,	// alpha byte is written as 0xFF
+	GBV_RENDER_MODE_PACKED_2,	// shade after bgp/obp, 2 bits per pixel, first pixel in the high bits, no palette
 } gbv_render_mode;
 
 typedef struct {
 	gbv_u8 colors[4];
 } gbv_palette;
 
+/* output scaling, applies to 8 and 32 bit render modes */
+typedef enum {
+	GBV_SCALE_1X,
+	GBV_SCALE_2X,	// nearest neighbor
+	GBV_SCALE_3X,
+	GBV_SCALE_4X,
+	GBV_SCALE_EPX,	// 2x, scale2x/EPX smoothing of diagonal edges
+} gbv_scale_mode;
+
+/* colors are given as 0xAARRGGBB and converted to the render mode */
+typedef struct {
+	gbv_u32 colors[4];
+} gbv_palette32;
+
+/*
+  output of a frame
+    - pitch is the distance between rows in bytes, 0 means rows are packed
+    - 8 bit modes use palette, 32 bit modes use palette32,
+      if palette32 is 0 the gray levels of palette are used instead
+    - scaled output is written one scanline at a time, epx output of a line is written when the line below is done
+*/
+typedef struct {
+	void * buffer;
+	int pitch;
+	gbv_render_mode mode;
+	gbv_palette * palette;
+	gbv_palette32 * palette32;
+	gbv_scale_mode scale;
+} gbv_render_target;
+
 typedef enum {
 	GBV_LCDC_BG_ENABLE       = 0x01, /* enable bg display */
 	GBV_LCDC_OBJ_ENABLE      = 0x02, /* enable obj display */
@@ -80,6 +159,13 @@ typedef enum {
 	GBV_OBJ_ATTR_PRIORITY_FLAG   = 0x80, /* display priority flag */
 } gbv_obj_attr;
 
+typedef enum {
+	GBV_DECODE_KERNEL_AUTO,   /* fastest kernel supported by the cpu */
+	GBV_DECODE_KERNEL_SCALAR, /* portable 64 bit multiply */
+	GBV_DECODE_KERNEL_SSE2,   /* x86 sse2, two rows at a time */
+	GBV_DECODE_KERNEL_BMI2,   /* x86-64 pdep */
+} gbv_decode_kernel;
+
 typedef struct {
 	gbv_u8 data[8][2];
 } gbv_tile;
@@ -91,8 +177,104 @@ typedef struct {
 	gbv_u8 attr;
 } gbv_obj_char;
 
+/* I/O control registers of a context, see the gbv_io_* globals below */
+typedef struct {
+	gbv_io lcdc;
+	gbv_io bgp;
+	gbv_io obp0;
+	gbv_io obp1;
+	gbv_io scx;
+	gbv_io scy;
+	gbv_io lyc;
+	gbv_io wx;
+	gbv_io wy;
+} gbv_io_regs;
+
+/*
+  independent video unit, owned by the caller
+    - io may be read and written directly like the gbv_io_* globals
+    - state is internal, initialize it with gbv_init_ctx
+*/
+typedef struct gbv_context gbv_context;
+struct gbv_context {
+	gbv_io_regs io;
+	union {
+		gbv_u8 data[GBV_CONTEXT_STATE_SIZE];
+		void * align_ptr;
+		unsigned long long align_u64;
+	} state;
+};
+
 /* user defined callback function used for interrupt handling */
 typedef void (*gbv_int_callback)(void);
+typedef void (*gbv_ctx_int_callback)(gbv_context * ctx, void * user_data);
+
+/*
+  user defined parallel for used by band rendering
+    - has to call job(job_data, i) once for every i in [0, count), in any order and on any thread
+    - must not return before all calls have returned
+*/
+typedef void (*gbv_band_job)(void * job_data, int index);
+typedef void (*gbv_parallel_for)(gbv_band_job job, void * job_data, int count, void * user_data);
+
+/* user defined callback receiving the row_count output rows of scanline ly as soon as they are written */
+typedef void (*gbv_line_sink)(int ly, const void * rows, int row_count, int pitch, void * user_data);
+
+/*
+  instrumentation of the current or last frame, only collected when gbv.cpp is compiled with GBV_STATS defined
+  timers are TSC ticks on x86 and 0 on other platforms
+*/
+typedef struct {
+	unsigned long long oam_search_ticks;
+	unsigned long long transfer_ticks;    /* pixel transfer and output, with band rendering the time spent in parallel_for */
+	unsigned long long callback_ticks;    /* time spent in STAT callbacks */
+	int lines;                            /* scanlines transferred */
+	int objects;                          /* objects selected by OAM search, summed over all lines */
+	int max_objects_per_line;
+	int lines_at_object_limit;            /* lines with 10 objects, more may have been dropped */
+	int window_pixels;
+	int callbacks;                        /* STAT callbacks fired */
+} gbv_stats;
+
+/* line cache counters, see gbv_set_line_cache */
+typedef struct {
+	int hits;                        /* lines of the last frame reused from the previous one */
+	int misses;                      /* lines of the last frame rendered */
+	unsigned long long total_hits;   /* since gbv_set_line_cache */
+	unsigned long long total_misses;
+} gbv_line_cache_stats;
+
+/* receives the bytes of a trace in order, append them to a file or buffer */
+typedef void (*gbv_trace_write)(const void * data, int size, void * user_data);
+
+/*
+  regions written since the dirty state was last cleared, see gbv_write_vram
+    - tiles has one bit per 16 byte tile of tile data (0x8000 - 0x97FF), tile 0 in bit 0 of the first byte
+    - map_rows has one bit per 32 byte row of tile map 0 (0x9800, rows 0 - 31) and tile map 1 (0x9C00, rows 32 - 63)
+    - oam has one bit per object (0xFE00 - 0xFE9F)
+    - all is set when memory may have been written through a raw pointer, every bit is set as well
+*/
+typedef struct {
+	gbv_u8 tiles[GBV_TILE_COUNT / 8];
+	gbv_u8 map_rows[2 * GBV_BG_TILES_Y / 8];
+	gbv_u8 oam[GBV_OBJ_COUNT / 8];
+	gbv_u8 all;
+} gbv_dirty_regions;
+
+/* screen area in lcd pixels, multiply by the scale of the render mode for output pixels */
+typedef struct {
+	gbv_u8 x;
+	gbv_u8 y;
+	gbv_u8 width;
+	gbv_u8 height;
+} gbv_damage_rect;
+
+/* read position in a recorded trace, see gbv_trace_player_init */
+typedef struct {
+	const void * data;
+	int size;
+	int pos;
+} gbv_trace_player;
 
 /*****************************/
 /*** I/O control registers ***/
@@ -139,7 +321,11 @@ extern GBV_API void gbv_lcdc_reset(gbv_lcdc_flag flag);
 extern GBV_API void gbv_stat_set(gbv_stat_flag flag);
 extern GBV_API void gbv_stat_reset(gbv_stat_flag flag);
 
-/* return raw pointers for data specification */
+/*
+  return raw pointers for data specification
+    - writes through them aren't tracked, getting a pointer marks all regions dirty (gbv_get_tile only its tile),
+      call gbv_mark_all_dirty after writing through a pointer that was kept
+*/
 extern GBV_API gbv_u8 * gbv_get_rom_data();
 extern GBV_API gbv_u8 * gbv_get_tile_map0();
 extern GBV_API gbv_u8 * gbv_get_tile_map1();
@@ -147,6 +333,20 @@ extern GBV_API gbv_u8 * gbv_get_tile_map1();
 extern GBV_API gbv_u8   * gbv_get_tile_data();
 extern GBV_API gbv_tile * gbv_get_tile(gbv_u8 tile_id);
 
+/*
+  write length bytes of src to address in the 64k address space, returns the number of bytes written
+    - writes to tile data, tile maps and OAM mark the tiles, map rows and objects they touch dirty
+*/
+extern GBV_API int  gbv_write_vram(int address, const void * src, int length);
+extern GBV_API void gbv_write8(int address, gbv_u8 value);
+
+/* copy the regions written since the last gbv_clear_dirty, returns 1 if any region is dirty */
+extern GBV_API int  gbv_get_dirty(gbv_dirty_regions * dirty);
+extern GBV_API void gbv_clear_dirty();
+
+/* fallback for writes through raw pointers, assume everything changed */
+extern GBV_API void gbv_mark_all_dirty();
+
 /* LCD status register */
 extern GBV_API void gbv_stat_set(gbv_stat_flag flag);
 extern GBV_API void gbv_stat_reset(gbv_stat_flag flag);
@@ -163,10 +363,253 @@ extern GBV_API gbv_io gbv_ly();
 /* set user defined callback for LCDC status interrupt */
 extern GBV_API void gbv_lcdc_set_stat_interrupt(gbv_int_callback callback);
 
+/* select tile row decoder, returns 0 if the kernel is not supported by this cpu */
+extern GBV_API int gbv_set_decode_kernel(gbv_decode_kernel kernel);
+
+/* decode count tile rows (2 bitplane bytes each) to 8 palette indices per row */
+extern GBV_API void gbv_decode_tile_rows(const gbv_u8 * rows, int count, gbv_u8 * indices);
+
+/*
+  optional cache of decoded tile data, provide GBV_TILE_CACHE_SIZE bytes of 8 byte aligned memory or 0 to disable
+    - tiles are compared against a shadow copy before each frame, after each interrupt callback, before the next
+      line after gbv_render_scanline, gbv_step or gbv_mark_all_dirty returned, only changed tiles are decoded again
+*/
+extern GBV_API void gbv_set_tile_cache(void * memory);
+
+/*
+  optional cache of pre-rendered bg layers, provide GBV_BG_LAYER_CACHE_SIZE bytes of 8 byte aligned memory or 0 to disable
+    - keeps the palette indices of both tile maps as 256x256 layers, one for each tile data select,
+      bg and wnd lines are copied out of them with wrap-around instead of being fetched tile by tile
+    - a layer is built the first time a line uses it, then only the map cells whose tile id or tile data changed
+      are drawn again, changes are found like for the tile cache
+*/
+extern GBV_API void gbv_set_bg_layer_cache(void * memory);
+
+/*
+  optional scanline memoization, provide GBV_LINE_CACHE_SIZE bytes of 8 byte aligned memory or 0 to disable
+    - the inputs of every scanline are hashed: LCDC, SCX/SCY, WX/WY, the tile map rows of bg and wnd
+      and the OAM entries of the selected objects, tile data changes are tracked per tile like for the tile cache
+    - when a line hashes the same as the line at that position in the previous frame and none of its tiles changed,
+      its pixels are reused, only BGP, OBP0, OBP1 and the output are applied again
+    - hash collisions between different lines are possible, but very unlikely with 64 bits
+*/
+extern GBV_API void gbv_set_line_cache(void * memory);
+
+/* hit and miss counters of the line cache, returns 0 and clears stats if it is disabled */
+extern GBV_API int gbv_get_line_cache_stats(gbv_line_cache_stats * stats);
+
+/*
+  optional band rendering, provide GBV_BAND_MEMORY_SIZE bytes of 8 byte aligned memory or 0 to disable
+    - OAM search and interrupt callbacks run serially and record the registers seen by every scanline
+    - the pixel transfer of the recorded lines is split into band_count horizontal bands and handed to parallel_for,
+      user_data is passed along
+    - callbacks, and the caller between gbv_render_scanline or gbv_step calls, may still change registers,
+      tile data, tile maps and OAM, the output is the same as without bands
+    - lines are rendered whenever video memory changed before the next line and before the v-blank callback
+*/
+extern GBV_API void gbv_set_band_rendering(void * memory, int band_count, gbv_parallel_for parallel_for, void * user_data);
+
 /* copy GBV_OBJ_SIZE bytes of data to OAM memory */
 extern GBV_API void gbv_transfer_oam_data(gbv_obj_char objs[GBV_OBJ_COUNT]);
 
 /* render all data to target buffer */
 extern GBV_API void gbv_render(void * render_buffer, gbv_render_mode mode, gbv_palette * palette);
 
+/*
+  render all data to a buffer with any pitch and pixel format
+    - with a 0 target or target buffer, LY, STAT modes and interrupt callbacks advance exactly like when
+      rendering, but no pixels are produced, for fast-forwarding (also for gbv_begin_frame and gbv_step)
+    - without a STAT callback, band rendering or line cache nothing can change between lines, the frame is drawn
+      a layer at a time (bg, window, objects, palettes) instead of line by line, with the same output
+*/
+extern GBV_API void gbv_render_to(const gbv_render_target * target);
+
+/* render every nth call to target and run the others without pixels, returns 1 if this frame was drawn */
+extern GBV_API int gbv_render_every(const gbv_render_target * target, int n);
+
+/*
+  render one scanline at a time
+    - gbv_begin_frame starts a frame, gbv_render_scanline runs OAM search, transfer and h-blank of line ly,
+      lines have to be rendered in order from 0, other calls are ignored and return 0
+    - registers and video memory may be changed between scanlines, also through the raw pointers
+    - gbv_end_frame renders the remaining lines and enters v-blank
+    - gbv_render_to is the same as gbv_begin_frame followed by gbv_end_frame
+*/
+extern GBV_API void gbv_begin_frame(const gbv_render_target * target);
+extern GBV_API int  gbv_render_scanline(int ly);
+extern GBV_API void gbv_end_frame();
+
+/*
+  advance the video unit by cycles dots, returns the number of frames finished (v-blank entered)
+    - LY, STAT mode and interrupts change at the mode boundaries of each line, lines 144 to 153 are v-blank
+    - a new frame is started on target whenever line 0 begins, if the lcd is off at that point
+      the clock waits there until it is turned on and the frame starts then
+    - the LYC interrupt only fires on visible lines, like with gbv_render
+    - registers and video memory may be written between calls, also through the raw pointers
+    - don't mix with gbv_render or gbv_begin_frame while a frame is in progress
+*/
+extern GBV_API int gbv_step(const gbv_render_target * target, int cycles);
+
+/*
+  number of dots gbv_step has to advance until the next enabled STAT interrupt source fires, -1 if none will
+    - ly and dot receive the line and the dot within the line of the event, pass 0 if not needed
+    - based on the current STAT interrupt enables, LYC and LCDC, so ask again after changing them
+    - with the lcd off, only events before the start of the next frame are reported
+*/
+extern GBV_API int gbv_next_stat_event(int * ly, int * dot);
+
+/*
+  optional line sink, called with the output rows of each finished scanline, 0 to disable
+    - called right after the transfer of a line, epx output of a line is ready after the transfer of the next one
+    - with band rendering lines are finished in batches, the sink is still called in order on the rendering thread
+*/
+extern GBV_API void gbv_set_line_sink(gbv_line_sink sink, void * user_data);
+
+/*
+  optional retained frame, provide GBV_RETAINED_FRAME_SIZE bytes of memory or 0 to disable
+    - every rendered frame stores the palette (BGP, OBP0, OBP1) and palette index of its pixels there
+*/
+extern GBV_API void gbv_set_retained_frame(void * memory);
+
+/*
+  render the retained frame again with the current BGP, OBP0 and OBP1 and the palette of target,
+  returns 0 if no frame was retained yet
+    - for frames where only palettes changed, e.g. fades, no tiles or objects are fetched and no callbacks run
+    - palette changes made by callbacks during the retained frame are replaced by the current registers
+    - the line sink is called like for a rendered frame
+*/
+extern GBV_API int gbv_recolor(const gbv_render_target * target);
+
+/*
+  optional damage tracking, provide GBV_DAMAGE_MEMORY_SIZE bytes of 8 byte aligned memory or 0 to disable
+    - every rendered frame is compared with the previous one, gbv_get_damage reports the pixels that changed
+    - when VRAM, OAM, the gbv_io_* registers, the output buffer and the palette are the same as at the start
+      of the previous frame, the scanlines that frame rendered before any of them changed are not rendered again,
+      the buffer has to still hold the previous output and those lines aren't passed to the line sink
+    - interrupt callbacks still fire as usual, changes they make are picked up before the next line
+    - lines are always rendered with epx output, changes are still reported
+*/
+extern GBV_API void gbv_set_damage_tracking(void * memory);
+
+/*
+  changed areas of the last frame, consecutive changed lines are merged into one rect,
+  returns the number of rects written, 0 if nothing changed or -1 if tracking is disabled
+    - the first frame after enabling tracking, a change of the output or gbv_recolor damages the whole screen
+    - frames without pixels (fast-forward, lcd off) leave the buffer alone and report no damage
+    - when there are more than max_rects areas, the last rect is grown to cover the rest
+*/
+extern GBV_API int gbv_get_damage(gbv_damage_rect * rects, int max_rects);
+
+/*
+  record what the caller does to the video unit, provide GBV_TRACE_MEMORY_SIZE bytes of memory
+    - every frame stores the changes to VRAM, OAM, the gbv_io_* registers and the STAT interrupt enables
+      since the previous frame, and the changes made by each STAT callback right after it returns
+    - the first frame after gbv_start_trace holds the complete state, so does the first one after gbv_init,
+      which keeps the trace running like the other settings
+    - write is called with whole frames, except when one doesn't fit the 4k buffer,
+      and with the rest when gbv_stop_trace is called
+    - changes made between gbv_render_scanline or gbv_step calls of a frame are recorded with the next frame
+
+  format: "GBVT", version byte (1), 3 zero bytes, then a stream of records starting with a type byte
+    0x01 flags          start of a frame, flags bit 0: a STAT callback was set
+    0x02                start of the changes made by the next STAT callback
+    0x03 index value    register write, index is the byte offset in gbv_io_regs
+    0x04 value          STAT interrupt enable bits
+    0x05 address length data  memory write, address and length are little endian 16 bit, followed by length bytes
+*/
+extern GBV_API void gbv_start_trace(void * memory, gbv_trace_write write, void * user_data);
+extern GBV_API void gbv_stop_trace();
+
+/* start reading a trace from memory, e.g. a mapped file, returns 0 if data isn't a trace */
+extern GBV_API int gbv_trace_player_init(gbv_trace_player * player, const void * data, int size);
+
+/*
+  apply the next frame of a trace and render it to target, returns 0 at the end of the trace
+    - the recorded callback changes are applied while rendering, the callback set with
+      gbv_lcdc_set_stat_interrupt isn't called
+*/
+extern GBV_API int gbv_play_trace_frame(gbv_trace_player * player, const gbv_render_target * target);
+
+/*
+  copy the stats of the frame in progress or the last one, they are reset whenever a frame begins
+  returns 0 and clears stats if gbv.cpp was compiled without GBV_STATS
+*/
+extern GBV_API int gbv_get_stats(gbv_stats * stats);
+
+/* convert a GBV_RENDER_MODE_PACKED_2 frame to any render target, packed_pitch 0 means rows are packed */
+extern GBV_API void gbv_convert_packed(const void * packed, int packed_pitch, const gbv_render_target * target);
+
+/*****************************/
+/******** context API ********/
+/*****************************/
+
+/*
+  same as the functions above, but operating on a caller owned context instead of the module globals
+  contexts don't share any state, so each one may be used from a different thread
+  the global API is a wrapper around one internal context
+*/
+
+/* initialize context, provide GBV_HW_MEMORY_SIZE (64k) of memory */
+extern GBV_API void gbv_init_ctx(gbv_context * ctx, void * memory);
+
+extern GBV_API void gbv_lcdc_set_ctx(gbv_context * ctx, gbv_lcdc_flag flag);
+extern GBV_API void gbv_lcdc_reset_ctx(gbv_context * ctx, gbv_lcdc_flag flag);
+
+extern GBV_API void gbv_stat_set_ctx(gbv_context * ctx, gbv_stat_flag flag);
+extern GBV_API void gbv_stat_reset_ctx(gbv_context * ctx, gbv_stat_flag flag);
+
+extern GBV_API gbv_u8 * gbv_get_rom_data_ctx(gbv_context * ctx);
+extern GBV_API gbv_u8 * gbv_get_tile_map0_ctx(gbv_context * ctx);
+extern GBV_API gbv_u8 * gbv_get_tile_map1_ctx(gbv_context * ctx);
+
+extern GBV_API gbv_u8   * gbv_get_tile_data_ctx(gbv_context * ctx);
+extern GBV_API gbv_tile * gbv_get_tile_ctx(gbv_context * ctx, gbv_u8 tile_id);
+
+extern GBV_API int  gbv_write_vram_ctx(gbv_context * ctx, int address, const void * src, int length);
+extern GBV_API void gbv_write8_ctx(gbv_context * ctx, int address, gbv_u8 value);
+extern GBV_API int  gbv_get_dirty_ctx(gbv_context * ctx, gbv_dirty_regions * dirty);
+extern GBV_API void gbv_clear_dirty_ctx(gbv_context * ctx);
+extern GBV_API void gbv_mark_all_dirty_ctx(gbv_context * ctx);
+
+extern GBV_API gbv_lcd_mode gbv_stat_mode_ctx(gbv_context * ctx);
+extern GBV_API gbv_u8 gbv_stat_lyc_ctx(gbv_context * ctx);
+extern GBV_API gbv_io gbv_ly_ctx(gbv_context * ctx);
+
+/* user_data is passed to the callback */
+extern GBV_API void gbv_lcdc_set_stat_interrupt_ctx(gbv_context * ctx, gbv_ctx_int_callback callback, void * user_data);
+
+extern GBV_API void gbv_set_tile_cache_ctx(gbv_context * ctx, void * memory);
+extern GBV_API void gbv_set_bg_layer_cache_ctx(gbv_context * ctx, void * memory);
+extern GBV_API void gbv_set_line_cache_ctx(gbv_context * ctx, void * memory);
+extern GBV_API int  gbv_get_line_cache_stats_ctx(gbv_context * ctx, gbv_line_cache_stats * stats);
+
+extern GBV_API void gbv_set_band_rendering_ctx(gbv_context * ctx, void * memory, int band_count, gbv_parallel_for parallel_for, void * user_data);
+
+extern GBV_API void gbv_transfer_oam_data_ctx(gbv_context * ctx, gbv_obj_char objs[GBV_OBJ_COUNT]);
+
+extern GBV_API void gbv_render_ctx(gbv_context * ctx, void * render_buffer, gbv_render_mode mode, gbv_palette * palette);
+extern GBV_API void gbv_render_to_ctx(gbv_context * ctx, const gbv_render_target * target);
+extern GBV_API int  gbv_render_every_ctx(gbv_context * ctx, const gbv_render_target * target, int n);
+
+extern GBV_API void gbv_begin_frame_ctx(gbv_context * ctx, const gbv_render_target * target);
+extern GBV_API int  gbv_render_scanline_ctx(gbv_context * ctx, int ly);
+extern GBV_API void gbv_end_frame_ctx(gbv_context * ctx);
+
+extern GBV_API int gbv_step_ctx(gbv_context * ctx, const gbv_render_target * target, int cycles);
+extern GBV_API int gbv_next_stat_event_ctx(gbv_context * ctx, int * ly, int * dot);
+
+extern GBV_API void gbv_set_line_sink_ctx(gbv_context * ctx, gbv_line_sink sink, void * user_data);
+
+extern GBV_API void gbv_set_retained_frame_ctx(gbv_context * ctx, void * memory);
+extern GBV_API int  gbv_recolor_ctx(gbv_context * ctx, const gbv_render_target * target);
+
+extern GBV_API void gbv_set_damage_tracking_ctx(gbv_context * ctx, void * memory);
+extern GBV_API int  gbv_get_damage_ctx(gbv_context * ctx, gbv_damage_rect * rects, int max_rects);
+
+extern GBV_API int  gbv_get_stats_ctx(gbv_context * ctx, gbv_stats * stats);
+
+extern GBV_API void gbv_start_trace_ctx(gbv_context * ctx, void * memory, gbv_trace_write write, void * user_data);
+extern GBV_API void gbv_stop_trace_ctx(gbv_context * ctx);
+extern GBV_API int  gbv_play_trace_frame_ctx(gbv_context * ctx, gbv_trace_player * player, const gbv_render_target * target);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,453 @@
+#include "gbv.h"
+#include "test_data.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#define DECODE_ROWS        (GBV_TILE_MEMORY_SIZE / GBV_TILE_PITCH)
+#define DECODE_ITERATIONS  2000
+#define SCANLINE_ROWS      21
+
+#define SCENE_WARMUP_FRAMES 200
+#define SCENE_FRAMES        2000
+#define MAX_SCENE_FRAMES    100000
+
+/* tile ids of the test scene, same as test_sdl.cpp */
+#define TEST_TILE0     20
+#define GLYPH_ID_START 24
+
+typedef std::chrono::steady_clock bench_clock;
+
+/* per pixel reference decoder, same as gbv.cpp before the row kernels */
+static gbv_u8 get_pal_idx_from_tile_row(gbv_u8 row[2], gbv_u8 x) {
+	gbv_u8 pal_idx = ((row[0] >> (7 - x)) & 0x01) | ((row[1] >> (7 - x) & 0x01) << 1);
+	return pal_idx;
+}
+
+static void decode_rows_reference(gbv_u8 * rows, int count, gbv_u8 * out) {
+	for (int i = 0; i < count; i++) {
+		for (gbv_u8 x = 0; x < GBV_TILE_WIDTH; x++) {
+			out[GBV_TILE_WIDTH * i + x] = get_pal_idx_from_tile_row(rows + GBV_TILE_PITCH * i, x);
+		}
+	}
+}
+
+static double elapsed_ns(bench_clock::time_point start) {
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+}
+
+static unsigned int checksum(gbv_u8 * data, int size) {
+	unsigned int sum = 0;
+	for (int i = 0; i < size; i++) {
+		sum = sum * 31 + data[i];
+	}
+	return sum;
+}
+
+static void bench_decode(const char * name, gbv_decode_kernel kernel, gbv_u8 * rows, gbv_u8 * out) {
+	if (kernel != GBV_DECODE_KERNEL_AUTO && !gbv_set_decode_kernel(kernel)) {
+		fprintf(stdout, "  %-10s not supported\n", name);
+		return;
+	}
+
+	/* all tile rows at once */
+	bench_clock::time_point start = bench_clock::now();
+	for (int i = 0; i < DECODE_ITERATIONS; i++) {
+		if (kernel == GBV_DECODE_KERNEL_AUTO) {
+			decode_rows_reference(rows, DECODE_ROWS, out);
+		}
+		else {
+			gbv_decode_tile_rows(rows, DECODE_ROWS, out);
+		}
+	}
+	double tile_ns = elapsed_ns(start) / ((double)DECODE_ITERATIONS * DECODE_ROWS);
+	unsigned int sum = checksum(out, DECODE_ROWS * GBV_TILE_WIDTH);
+
+	/* one scanline worth of fetched rows */
+	start = bench_clock::now();
+	for (int i = 0; i < DECODE_ITERATIONS; i++) {
+		for (int r = 0; r + SCANLINE_ROWS <= DECODE_ROWS; r += SCANLINE_ROWS) {
+			if (kernel == GBV_DECODE_KERNEL_AUTO) {
+				decode_rows_reference(rows + GBV_TILE_PITCH * r, SCANLINE_ROWS, out + GBV_TILE_WIDTH * r);
+			}
+			else {
+				gbv_decode_tile_rows(rows + GBV_TILE_PITCH * r, SCANLINE_ROWS, out + GBV_TILE_WIDTH * r);
+			}
+		}
+	}
+	double line_ns = elapsed_ns(start) / ((double)DECODE_ITERATIONS * (DECODE_ROWS / SCANLINE_ROWS));
+
+	fprintf(stdout, "  %-10s %6.2f ns/row  %7.1f ns/scanline  checksum %08x\n", name, tile_ns, line_ns, sum);
+}
+
+/*
+  rendering scenes, built from the test_sdl.cpp data
+  setup runs once after gbv_init, update before every frame
+*/
+struct bench_scene {
+	const char * name;
+	void (*setup)();
+	void (*update)(int frame);
+};
+
+static gbv_obj_char scene_objs[GBV_OBJ_COUNT];
+
+static void setup_bg() {
+	/* test_data.h has 8 bg tiles, test_sdl.cpp loads 16 and reads past them */
+	for (int i = 0; i < (int)(sizeof(bg_tiles) / GBV_TILE_SIZE); i++) {
+		memcpy(gbv_get_tile(i + 1), bg_tiles + i * GBV_TILE_SIZE, GBV_TILE_SIZE);
+	}
+	memcpy(gbv_get_tile_map0(), testmap, GBV_BG_MAP_MEMORY_SIZE);
+	gbv_io_bgp = 0xE4;
+	gbv_lcdc_set(GBV_LCDC_CTRL);
+	gbv_lcdc_set(GBV_LCDC_BG_ENABLE);
+}
+
+static void update_scroll(int frame) {
+	gbv_io_scx = (gbv_u8)frame;
+	gbv_io_scy = (gbv_u8)(frame / 2);
+}
+
+/* status bar in the window on the first 8 lines, like the display of test_sdl.cpp */
+static void split_callback() {
+	switch (gbv_stat_mode()) {
+	case GBV_LCD_MODE_TRANSFER:
+		if (gbv_stat_lyc()) {
+			gbv_lcdc_reset(GBV_LCDC_WND_ENABLE);
+		}
+		break;
+	case GBV_LCD_MODE_VBLANK:
+		gbv_lcdc_set(GBV_LCDC_WND_ENABLE);
+		break;
+	default:
+		break;
+	}
+}
+
+static void setup_window_split() {
+	setup_bg();
+	memcpy(gbv_get_tile(TEST_TILE0), test_tiles, sizeof(test_tiles));
+	memcpy(gbv_get_tile(GLYPH_ID_START), glyph_data, sizeof(glyph_data));
+	const char * text = "001  002  003  004";
+	for (int i = 0; text[i]; i++) {
+		gbv_get_tile_map1()[i] = (text[i] == ' ') ? TEST_TILE0 + i % 4 : GLYPH_ID_START + text[i];
+	}
+	gbv_io_wx = 7;
+	gbv_io_wy = 0;
+	gbv_io_lyc = 8;
+	gbv_lcdc_set(GBV_LCDC_WND_MAP_SELECT);
+	gbv_lcdc_set(GBV_LCDC_WND_ENABLE);
+	gbv_stat_set(GBV_STAT_LYC_INT);
+	gbv_stat_set(GBV_STAT_VBLANK_INT);
+	gbv_lcdc_set_stat_interrupt(split_callback);
+}
+
+static void setup_sprites() {
+	setup_bg();
+	memcpy(gbv_get_tile(TEST_TILE0), test_tiles, sizeof(test_tiles));
+	gbv_io_obp0 = 0xD0;
+	gbv_io_obp1 = 0xE4;
+	gbv_lcdc_set(GBV_LCDC_OBJ_ENABLE);
+	for (int i = 0; i < GBV_OBJ_COUNT; i++) {
+		scene_objs[i].id = TEST_TILE0 + i % 4;
+		scene_objs[i].attr = (i & 1) ? GBV_OBJ_ATTR_PALETTE_SELECT : GBV_OBJ_ATTR_PRIORITY_FLAG;
+	}
+}
+
+static void setup_sprites_8x16() {
+	setup_sprites();
+	gbv_lcdc_set(GBV_LCDC_OBJ_SIZE_SELECT);
+}
+
+/* 8 columns and 5 rows of objects moving across the screen, at most 8 on a line */
+static void update_sprites(int frame) {
+	update_scroll(frame);
+	for (int i = 0; i < GBV_OBJ_COUNT; i++) {
+		scene_objs[i].x = (gbv_u8)(8 + 20 * (i % 8) + frame % 16);
+		scene_objs[i].y = (gbv_u8)(16 + 28 * (i / 8) + frame % 8);
+	}
+	gbv_transfer_oam_data(scene_objs);
+}
+
+/* same as bg_scroll and window_split, with the pre-rendered bg layers */
+static unsigned long long bg_layers[GBV_BG_LAYER_CACHE_SIZE / 8];
+
+static void setup_bg_layers() {
+	setup_bg();
+	gbv_set_bg_layer_cache(bg_layers);
+}
+
+static void setup_window_layers() {
+	setup_window_split();
+	gbv_set_bg_layer_cache(bg_layers);
+}
+
+/* same as bg and sprites_8x8, with the line cache */
+static unsigned long long line_cache[GBV_LINE_CACHE_SIZE / 8];
+
+static void setup_bg_lines() {
+	setup_bg();
+	gbv_set_line_cache(line_cache);
+}
+
+static void setup_sprite_lines() {
+	setup_sprites();
+	gbv_set_line_cache(line_cache);
+}
+
+/* same as bg and sprites_8x8 with damage tracking, unchanged frames keep their lines */
+static unsigned long long damage[GBV_DAMAGE_MEMORY_SIZE / 8];
+
+static void setup_bg_damage() {
+	setup_bg();
+	gbv_set_damage_tracking(damage);
+}
+
+static void setup_sprite_damage() {
+	setup_sprites();
+	gbv_set_damage_tracking(damage);
+}
+
+/* same as sprites_8x8, the pixel transfer split into bands on one thread each */
+#define BENCH_BANDS 4
+
+static unsigned long long bands[GBV_BAND_MEMORY_SIZE / 8];
+
+static void thread_for(gbv_band_job job, void * job_data, int count, void * user_data) {
+	(void)user_data;
+	std::thread threads[BENCH_BANDS];
+	for (int i = 1; i < count; i++) {
+		threads[i] = std::thread(job, job_data, i);
+	}
+	job(job_data, 0);
+	for (int i = 1; i < count; i++) {
+		threads[i].join();
+	}
+}
+
+static void setup_sprite_bands() {
+	setup_sprites();
+	gbv_set_band_rendering(bands, BENCH_BANDS, thread_for, 0);
+}
+
+static void setup_lcd_off() {
+	setup_bg();
+	gbv_lcdc_reset(GBV_LCDC_CTRL);
+}
+
+static const bench_scene scenes[] = {
+	{ "bg",            setup_bg,            0 },
+	{ "bg_scroll",     setup_bg,            update_scroll },
+	{ "window_split",  setup_window_split,  update_scroll },
+	{ "sprites_8x8",   setup_sprites,       update_sprites },
+	{ "sprites_8x16",  setup_sprites_8x16,  update_sprites },
+	{ "lcd_off",       setup_lcd_off,       0 },
+	{ "scroll_layers", setup_bg_layers,     update_scroll },
+	{ "window_layers", setup_window_layers, update_scroll },
+	{ "bg_lines",      setup_bg_lines,      0 },
+	{ "sprite_lines",  setup_sprite_lines,  update_sprites },
+	{ "bg_damage",     setup_bg_damage,     0 },
+	{ "sprite_damage", setup_sprite_damage, update_sprites },
+	{ "sprite_bands",  setup_sprite_bands,  update_sprites },
+};
+
+static double percentile(const double * sorted, int count, double p) {
+	int i = (int)(p * (count - 1) + 0.5);
+	return sorted[i];
+}
+
+/* sort the frame times and print them, results gets one line of key=value pairs */
+static void report_frames(const char * name, double * frame_ns, int frames, unsigned int sum, FILE * results) {
+	double total = 0;
+	for (int i = 0; i < frames; i++) {
+		total += frame_ns[i];
+	}
+	std::sort(frame_ns, frame_ns + frames);
+	double mean = total / frames;
+	double p50 = percentile(frame_ns, frames, 0.50);
+	double p90 = percentile(frame_ns, frames, 0.90);
+	double p99 = percentile(frame_ns, frames, 0.99);
+	double fps = 1e9 / mean;
+	double pixel_ns = mean / GBV_SCREEN_SIZE;
+
+	fprintf(stdout, "  %-13s %9.0f ns/frame  %8.0f fps  %6.2f ns/pixel  p50 %9.0f  p90 %9.0f  p99 %9.0f  checksum %08x\n",
+		name, mean, fps, pixel_ns, p50, p90, p99, sum);
+	if (results) {
+		fprintf(results, "scene=%s frames=%d mean_ns=%.0f p50_ns=%.0f p90_ns=%.0f p99_ns=%.0f min_ns=%.0f max_ns=%.0f fps=%.1f ns_per_pixel=%.3f checksum=%08x\n",
+			name, frames, mean, p50, p90, p99, frame_ns[0], frame_ns[frames - 1], fps, pixel_ns, sum);
+	}
+}
+
+static void bench_scene_frames(const bench_scene * scene, int frames, FILE * results) {
+	static gbv_u8 memory[GBV_HW_MEMORY_SIZE];
+	static gbv_u8 framebuffer[GBV_SCREEN_SIZE];
+	static double frame_ns[MAX_SCENE_FRAMES];
+	memset(memory, 0, sizeof(memory));
+	memset(framebuffer, 0, sizeof(framebuffer));
+	gbv_lcdc_set_stat_interrupt(0);
+	gbv_stat_reset(GBV_STAT_HBLANK_INT);
+	gbv_stat_reset(GBV_STAT_VBLANK_INT);
+	gbv_stat_reset(GBV_STAT_OAM_INT);
+	gbv_stat_reset(GBV_STAT_LYC_INT);
+	gbv_io_lcdc = gbv_io_bgp = gbv_io_obp0 = gbv_io_obp1 = 0;
+	gbv_io_scx = gbv_io_scy = gbv_io_lyc = gbv_io_wx = gbv_io_wy = 0;
+	gbv_set_bg_layer_cache(0);
+	gbv_set_line_cache(0);
+	gbv_set_damage_tracking(0);
+	gbv_set_band_rendering(0, 0, 0, 0);
+	gbv_init(memory);
+	scene->setup();
+
+	gbv_palette palette = { 0xFF, 0xAA, 0x55, 0x00 };
+	for (int i = 0; i < SCENE_WARMUP_FRAMES + frames; i++) {
+		bench_clock::time_point start = bench_clock::now();
+		if (scene->update) {
+			scene->update(i);
+		}
+		gbv_render(framebuffer, GBV_RENDER_MODE_GRAYSCALE_8, &palette);
+		if (i >= SCENE_WARMUP_FRAMES) {
+			frame_ns[i - SCENE_WARMUP_FRAMES] = elapsed_ns(start);
+		}
+	}
+	report_frames(scene->name, frame_ns, frames, checksum(framebuffer, GBV_SCREEN_SIZE), results);
+
+	gbv_line_cache_stats lines;
+	if (gbv_get_line_cache_stats(&lines)) {
+		unsigned long long total = lines.total_hits + lines.total_misses;
+		fprintf(stdout, "    line cache: %.1f%% hits\n", total ? 100.0 * lines.total_hits / total : 0.0);
+	}
+
+	gbv_damage_rect rects[8];
+	int rect_count = gbv_get_damage(rects, 8);
+	if (rect_count >= 0) {
+		int area = 0;
+		for (int i = 0; i < rect_count; i++) {
+			area += rects[i].width * rects[i].height;
+		}
+		fprintf(stdout, "    damage: %d rects, %d pixels\n", rect_count, area);
+	}
+
+	/* only available when gbv.cpp is built with GBV_STATS */
+	gbv_stats stats;
+	if (gbv_get_stats(&stats)) {
+		fprintf(stdout, "    last frame: oam search %llu, transfer %llu, callbacks %llu ticks, %d callbacks, %d objects (%d max per line, %d lines at the limit), %d window pixels\n",
+			stats.oam_search_ticks, stats.transfer_ticks, stats.callback_ticks, stats.callbacks,
+			stats.objects, stats.max_objects_per_line, stats.lines_at_object_limit, stats.window_pixels);
+	}
+}
+
+/* replay a recorded trace (gbv_start_trace) from the start as often as needed, every pass on a fresh context */
+static void bench_trace(const char * path, int frames, FILE * results) {
+	static gbv_u8 memory[GBV_HW_MEMORY_SIZE];
+	static gbv_u8 framebuffer[GBV_SCREEN_SIZE];
+	static double frame_ns[MAX_SCENE_FRAMES];
+	FILE * file = fopen(path, "rb");
+	if (!file) {
+		fprintf(stdout, "  %-13s can't open\n", path);
+		return;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	gbv_u8 * data = (gbv_u8*)malloc(size > 0 ? size : 1);
+	size_t read = fread(data, 1, size, file);
+	fclose(file);
+
+	gbv_trace_player player;
+	if ((long)read != size || !gbv_trace_player_init(&player, data, (int)size)) {
+		fprintf(stdout, "  %-13s not a trace\n", path);
+		free(data);
+		return;
+	}
+	gbv_context ctx;
+	gbv_palette palette = { 0xFF, 0xAA, 0x55, 0x00 };
+	gbv_render_target target = {};
+	target.buffer = framebuffer;
+	target.mode = GBV_RENDER_MODE_GRAYSCALE_8;
+	target.palette = &palette;
+	memset(framebuffer, 0, sizeof(framebuffer));
+	int played = 0;
+	int trace_frames = 0;
+	while (played < SCENE_WARMUP_FRAMES + frames) {
+		memset(memory, 0, sizeof(memory));
+		gbv_init_ctx(&ctx, memory);
+		gbv_trace_player_init(&player, data, (int)size);
+		int pass_frames = 0;
+		while (played < SCENE_WARMUP_FRAMES + frames) {
+			bench_clock::time_point start = bench_clock::now();
+			if (!gbv_play_trace_frame_ctx(&ctx, &player, &target)) {
+				break;
+			}
+			if (played >= SCENE_WARMUP_FRAMES) {
+				frame_ns[played - SCENE_WARMUP_FRAMES] = elapsed_ns(start);
+			}
+			played++;
+			pass_frames++;
+		}
+		if (!pass_frames) {
+			fprintf(stdout, "  %-13s has no frames\n", path);
+			free(data);
+			return;
+		}
+		trace_frames = (pass_frames > trace_frames) ? pass_frames : trace_frames;
+	}
+	free(data);
+	fprintf(stdout, "  %s: %ld bytes, %d frames per pass\n", path, size, trace_frames);
+	report_frames(path, frame_ns, frames, checksum(framebuffer, GBV_SCREEN_SIZE), results);
+}
+
+/* usage: gbv_bench [frames per scene] [results file] [trace files...] */
+int main(int argc, char *argv[]) {
+	int frames = (argc > 1) ? atoi(argv[1]) : SCENE_FRAMES;
+	const char * results_path = (argc > 2) ? argv[2] : "bench_output.txt";
+	if (frames < 1 || frames > MAX_SCENE_FRAMES) {
+		fprintf(stderr, "frames per scene must be between 1 and %d\n", MAX_SCENE_FRAMES);
+		return 1;
+	}
+
+	int maj, min, patch;
+	gbv_get_version(&maj, &min, &patch);
+	fprintf(stdout, "GBV %d.%d.%d benchmark\n", maj, min, patch);
+
+	static gbv_u8 rows[GBV_TILE_MEMORY_SIZE];
+	static gbv_u8 out[DECODE_ROWS * GBV_TILE_WIDTH];
+	unsigned int seed = 0x2545F491;
+	for (int i = 0; i < GBV_TILE_MEMORY_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		rows[i] = (gbv_u8)(seed >> 16);
+	}
+
+	fprintf(stdout, "\ntile row decode (%d rows, %d rows per scanline):\n", DECODE_ROWS, SCANLINE_ROWS);
+	bench_decode("reference", GBV_DECODE_KERNEL_AUTO, rows, out);
+	bench_decode("scalar", GBV_DECODE_KERNEL_SCALAR, rows, out);
+	bench_decode("sse2", GBV_DECODE_KERNEL_SSE2, rows, out);
+	bench_decode("bmi2", GBV_DECODE_KERNEL_BMI2, rows, out);
+	gbv_set_decode_kernel(GBV_DECODE_KERNEL_AUTO);
+
+	FILE * results = fopen(results_path, "w");
+	if (!results) {
+		fprintf(stderr, "can't open %s\n", results_path);
+	}
+	else {
+		fprintf(results, "gbv=%d.%d.%d warmup=%d\n", maj, min, patch, SCENE_WARMUP_FRAMES);
+	}
+	fprintf(stdout, "\nscenes (%d frames each after %d warmup frames, 8 bit output):\n", frames, SCENE_WARMUP_FRAMES);
+	for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+		bench_scene_frames(scenes + i, frames, results);
+	}
+	if (argc > 3) {
+		fprintf(stdout, "\ntraces (%d frames each after %d warmup frames):\n", frames, SCENE_WARMUP_FRAMES);
+		for (int i = 3; i < argc; i++) {
+			bench_trace(argv[i], frames, results);
+		}
+	}
+	if (results) {
+		fclose(results);
+		fprintf(stdout, "\nresults written to %s\n", results_path);
+	}
+
+	return 0;
+}
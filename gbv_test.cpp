@@ -0,0 +1,270 @@
+#include "gbv.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FRAMES 4
+#define TEST_SEED   0x2545F491
+
+enum test_feature {
+	TEST_TILE_CACHE = 0x01,
+	TEST_BG_LAYERS  = 0x02,
+	TEST_LINE_CACHE = 0x04,
+	TEST_BANDS      = 0x08,
+	TEST_MARK_DIRTY = 0x10, /* gbv_mark_all_dirty after the raw writes */
+};
+
+/* where the caller writes */
+enum test_writer {
+	TEST_WRITES_CALLBACK, /* in the h-blank callback of every line */
+	TEST_WRITES_SCANLINE, /* before every gbv_render_scanline */
+	TEST_WRITES_STEP,     /* before gbv_step runs the next line */
+	TEST_WRITES_FRAME,    /* once after gbv_begin_frame, gbv_end_frame draws the whole frame */
+	TEST_WRITES_LINES,    /* the same, the lines are drawn with gbv_render_scanline first */
+};
+
+static gbv_u8 memory[GBV_HW_MEMORY_SIZE];
+static gbv_u8 ref_frames[TEST_FRAMES][GBV_SCREEN_SIZE];
+static gbv_u8 test_frames[TEST_FRAMES][GBV_SCREEN_SIZE];
+static gbv_palette test_palette = { { 0x00, 0x55, 0xAA, 0xFF } };
+static unsigned int seed;
+
+static unsigned long long tile_cache[GBV_TILE_CACHE_SIZE / 8];
+static unsigned long long bg_layers[GBV_BG_LAYER_CACHE_SIZE / 8];
+static unsigned long long line_cache[GBV_LINE_CACHE_SIZE / 8];
+static unsigned long long bands[GBV_BAND_MEMORY_SIZE / 8];
+
+/* bytes written on every line */
+static int write_address;
+static int write_size;
+static int write_tracked;
+static int write_mark;
+
+static gbv_u8 next_random() {
+	seed = seed * 1103515245 + 12345;
+	return (gbv_u8)(seed >> 16);
+}
+
+static void serial_for(gbv_band_job job, void * job_data, int count, void * user_data) {
+	(void)user_data;
+	for (int i = 0; i < count; i++) {
+		job(job_data, i);
+	}
+}
+
+/* random tiles, maps and objects, bg, window and objects on */
+static void init_video(int features) {
+	gbv_init(memory);
+	seed = TEST_SEED;
+	for (int i = 0; i < GBV_TILE_MEMORY_SIZE + 2 * GBV_BG_MAP_MEMORY_SIZE; i++) {
+		memory[0x8000 + i] = next_random();
+	}
+	for (int i = 0; i < GBV_OAM_MEMORY_SIZE; i++) {
+		memory[0xFE00 + i] = next_random() % 168;
+	}
+	gbv_io_lcdc = GBV_LCDC_CTRL | GBV_LCDC_BG_ENABLE | GBV_LCDC_OBJ_ENABLE | GBV_LCDC_WND_ENABLE | GBV_LCDC_WND_MAP_SELECT;
+	gbv_io_bgp = 0xE4;
+	gbv_io_obp0 = 0xD2;
+	gbv_io_wx = 87;
+	gbv_io_wy = 100;
+	gbv_set_tile_cache((features & TEST_TILE_CACHE) ? tile_cache : 0);
+	gbv_set_bg_layer_cache((features & TEST_BG_LAYERS) ? bg_layers : 0);
+	gbv_set_line_cache((features & TEST_LINE_CACHE) ? line_cache : 0);
+	gbv_set_band_rendering((features & TEST_BANDS) ? bands : 0, 3, serial_for, 0);
+}
+
+static gbv_render_target get_target() {
+	gbv_render_target target;
+	memset(&target, 0, sizeof(target));
+	target.mode = GBV_RENDER_MODE_GRAYSCALE_8;
+	target.palette = &test_palette;
+	return target;
+}
+
+/*
+  a few random bytes in [write_address, write_address + write_size) straight to the memory given to gbv_init,
+  tracked writes pass OAM through gbv_transfer_oam_data afterwards
+*/
+static void write_random() {
+	for (int i = 0; i < 4; i++) {
+		int offset = (next_random() << 3 | next_random() >> 5) % write_size;
+		memory[write_address + offset] = next_random();
+	}
+	if (write_tracked && write_address == 0xFE00) {
+		gbv_obj_char objs[GBV_OBJ_COUNT];
+		memcpy(objs, memory + 0xFE00, sizeof(objs));
+		gbv_transfer_oam_data(objs);
+	}
+	if (write_mark) {
+		gbv_mark_all_dirty();
+	}
+}
+
+static void render_frames(int features, int tracked, int writer, gbv_u8 (*frames)[GBV_SCREEN_SIZE]) {
+	init_video(features);
+	write_tracked = tracked;
+	write_mark = (features & TEST_MARK_DIRTY) != 0;
+	if (writer == TEST_WRITES_CALLBACK) {
+		gbv_stat_set(GBV_STAT_HBLANK_INT);
+		gbv_lcdc_set_stat_interrupt(write_random);
+		for (int frame = 0; frame < TEST_FRAMES; frame++) {
+			gbv_render(frames[frame], GBV_RENDER_MODE_GRAYSCALE_8, &test_palette);
+		}
+		gbv_lcdc_set_stat_interrupt(0);
+		return;
+	}
+	gbv_render_target target = get_target();
+	int cycles = 0;
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		target.buffer = frames[frame];
+		if (writer == TEST_WRITES_FRAME || writer == TEST_WRITES_LINES) {
+			gbv_begin_frame(&target);
+			write_random();
+			for (int ly = 0; writer == TEST_WRITES_LINES && ly < GBV_SCREEN_HEIGHT; ly++) {
+				gbv_render_scanline(ly);
+			}
+			gbv_end_frame();
+			continue;
+		}
+		if (writer == TEST_WRITES_SCANLINE) {
+			gbv_begin_frame(&target);
+		}
+		for (int ly = 0; ly < GBV_SCREEN_HEIGHT; ly++) {
+			write_random();
+			if (writer == TEST_WRITES_SCANLINE) {
+				gbv_render_scanline(ly);
+			}
+			else {
+				/* runs line ly up to the last dot before the next one */
+				gbv_step(&target, cycles);
+				gbv_step(&target, GBV_DOTS_PER_LINE - 1);
+				cycles = 1;
+			}
+		}
+		if (writer == TEST_WRITES_SCANLINE) {
+			gbv_end_frame();
+		}
+		else {
+			gbv_step(&target, GBV_DOTS_PER_FRAME - GBV_SCREEN_HEIGHT * GBV_DOTS_PER_LINE);
+		}
+	}
+}
+
+/*
+  bytes in [address, address + size) written through a kept raw pointer on every line, the frames have to match
+  the ones rendered without caches from tracked writes, between scanlines for gbv_step and line by line for whole frames
+*/
+static int test_raw_writes(const char * name, int features, int writer, int address, int size) {
+	write_address = address;
+	write_size = size;
+	int ref_writer = writer;
+	if (writer == TEST_WRITES_STEP) {
+		ref_writer = TEST_WRITES_SCANLINE;
+	}
+	else if (writer == TEST_WRITES_FRAME) {
+		ref_writer = TEST_WRITES_LINES;
+	}
+	render_frames(0, 1, ref_writer, ref_frames);
+	render_frames(features, 0, writer, test_frames);
+	int failed = 0;
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		if (memcmp(ref_frames[frame], test_frames[frame], GBV_SCREEN_SIZE)) {
+			failed++;
+		}
+	}
+	fprintf(stdout, "  %-24s %s\n", name, failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
+
+static int trace_writes;
+
+static void count_trace_writes(const void * data, int size, void * user_data) {
+	(void)data;
+	(void)size;
+	(void)user_data;
+	trace_writes++;
+}
+
+/*
+  gbv_step with the lcd off waits at the start of the frame without beginning it on every call,
+  the frame starts once the lcd is turned on and matches one rendered with gbv_render_to
+*/
+static int test_lcd_off_step() {
+	static unsigned long long trace[GBV_TRACE_MEMORY_SIZE / 8];
+	gbv_render_target target = get_target();
+	init_video(0);
+	target.buffer = ref_frames[0];
+	gbv_render_to(&target);
+	init_video(0);
+	gbv_start_trace(trace, count_trace_writes, 0);
+	target.buffer = test_frames[0];
+	int failed = gbv_step(&target, GBV_DOTS_PER_FRAME - 1) != 1;
+	gbv_io_lcdc &= ~GBV_LCDC_CTRL;
+	trace_writes = 0;
+	for (int i = 0; i < 100; i++) {
+		failed += gbv_step(&target, GBV_DOTS_OAM) != 0;
+	}
+	failed += trace_writes != 0;
+	gbv_io_lcdc |= GBV_LCDC_CTRL;
+	failed += gbv_step(&target, GBV_DOTS_PER_FRAME - 1) != 1;
+	gbv_stop_trace();
+	failed += memcmp(ref_frames[0], test_frames[0], GBV_SCREEN_SIZE) != 0;
+	fprintf(stdout, "  %-24s %s\n", "lcd off, gbv_step", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
+
+int main() {
+	int maj, min, patch;
+	gbv_get_version(&maj, &min, &patch);
+	fprintf(stdout, "GBV %d.%d.%d tests\n", maj, min, patch);
+
+	int failed = 0;
+	fprintf(stdout, "\nraw tile map writes in STAT callbacks:\n");
+	failed += test_raw_writes("bg layers", TEST_BG_LAYERS, TEST_WRITES_CALLBACK, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("line cache", TEST_LINE_CACHE, TEST_WRITES_CALLBACK, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bands", TEST_BANDS, TEST_WRITES_CALLBACK, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw tile data writes in STAT callbacks:\n");
+	failed += test_raw_writes("tile cache", TEST_TILE_CACHE, TEST_WRITES_CALLBACK, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("tile cache, bands", TEST_TILE_CACHE | TEST_BANDS, TEST_WRITES_CALLBACK, 0x8000, GBV_TILE_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw OAM writes in STAT callbacks:\n");
+	failed += test_raw_writes("no caches", 0, TEST_WRITES_CALLBACK, 0xFE00, GBV_OAM_MEMORY_SIZE);
+	failed += test_raw_writes("bands", TEST_BANDS, TEST_WRITES_CALLBACK, 0xFE00, GBV_OAM_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw tile map writes between scanlines:\n");
+	failed += test_raw_writes("bg layers", TEST_BG_LAYERS, TEST_WRITES_SCANLINE, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bg layers, gbv_step", TEST_BG_LAYERS, TEST_WRITES_STEP, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bg layers, marked", TEST_BG_LAYERS | TEST_MARK_DIRTY, TEST_WRITES_SCANLINE, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("line cache", TEST_LINE_CACHE, TEST_WRITES_SCANLINE, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("line cache, gbv_step", TEST_LINE_CACHE, TEST_WRITES_STEP, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bands", TEST_BANDS, TEST_WRITES_SCANLINE, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bands, gbv_step", TEST_BANDS, TEST_WRITES_STEP, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("bands, marked", TEST_BANDS | TEST_MARK_DIRTY, TEST_WRITES_SCANLINE, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw tile data writes between scanlines:\n");
+	failed += test_raw_writes("tile cache", TEST_TILE_CACHE, TEST_WRITES_SCANLINE, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("tile cache, bands", TEST_TILE_CACHE | TEST_BANDS, TEST_WRITES_SCANLINE, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("tile cache, gbv_step", TEST_TILE_CACHE, TEST_WRITES_STEP, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("tile cache, marked", TEST_TILE_CACHE | TEST_MARK_DIRTY, TEST_WRITES_SCANLINE, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("bg layers", TEST_BG_LAYERS, TEST_WRITES_SCANLINE, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("all caches", TEST_TILE_CACHE | TEST_BG_LAYERS | TEST_LINE_CACHE, TEST_WRITES_SCANLINE, 0x8000, GBV_TILE_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw OAM writes between scanlines:\n");
+	failed += test_raw_writes("no caches", 0, TEST_WRITES_SCANLINE, 0xFE00, GBV_OAM_MEMORY_SIZE);
+	failed += test_raw_writes("bands", TEST_BANDS, TEST_WRITES_SCANLINE, 0xFE00, GBV_OAM_MEMORY_SIZE);
+	failed += test_raw_writes("gbv_step", 0, TEST_WRITES_STEP, 0xFE00, GBV_OAM_MEMORY_SIZE);
+	failed += test_raw_writes("bands, marked", TEST_BANDS | TEST_MARK_DIRTY, TEST_WRITES_SCANLINE, 0xFE00, GBV_OAM_MEMORY_SIZE);
+	failed += test_raw_writes("line cache", TEST_LINE_CACHE, TEST_WRITES_SCANLINE, 0xFE00, GBV_OAM_MEMORY_SIZE);
+
+	fprintf(stdout, "\nraw writes before gbv_end_frame draws the frame a layer at a time:\n");
+	failed += test_raw_writes("tile map, no caches", 0, TEST_WRITES_FRAME, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("tile map, bg layers", TEST_BG_LAYERS, TEST_WRITES_FRAME, 0x9800, 2 * GBV_BG_MAP_MEMORY_SIZE);
+	failed += test_raw_writes("tile data, tile cache", TEST_TILE_CACHE, TEST_WRITES_FRAME, 0x8000, GBV_TILE_MEMORY_SIZE);
+	failed += test_raw_writes("OAM, no caches", 0, TEST_WRITES_FRAME, 0xFE00, GBV_OAM_MEMORY_SIZE);
+
+	fprintf(stdout, "\nframe start:\n");
+	failed += test_lcd_off_step();
+
+	fprintf(stdout, "\n%d failed\n", failed);
+	return failed ? 1 : 0;
+}
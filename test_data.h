@@ -0,0 +1,407 @@
+#ifndef TEST_DATA_H
+#define TEST_DATA_H
+
+/* tiles and maps of the test scene, shared by test_sdl.cpp and gbv_bench.cpp */
+#include "gbv.h"
+
+/* 16 tiles, loaded to tile ids 1 to 16 */
+static unsigned char bg_tiles[] =
+{
+	0xFF,0xFF,0x01,0xFF,0x01,0xFF,0xF9,0x07,
+	0xF9,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
+	0x19,0x07,0x19,0x07,0x19,0x07,0xF9,0x07,
+	0xF9,0x07,0x01,0xFF,0x01,0xFF,0xFF,0xFF,
+	0x98,0xE0,0x98,0xE0,0x98,0xE0,0x9F,0xE0,
+	0x9F,0xE0,0x80,0xFF,0x80,0xFF,0xFF,0xFF,
+	0xFF,0xFF,0x80,0xFF,0x80,0xFF,0x9F,0xE0,
+	0x9F,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
+	0x19,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
+	0x19,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
+	0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+	0xFF,0x00,0x00,0xFF,0x00,0xFF,0xFF,0xFF,
+	0x98,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
+	0x98,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
+	0xFF,0xFF,0x00,0xFF,0x00,0xFF,0xFF,0x00,
+	0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00
+};
+
+static gbv_u8 testmap[] =
+{
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x04,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+	0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+	0x08,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x04,0x08,0x08,0x08,0x01,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x07,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x05,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
+	0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x03,0x06,0x06,0x06,0x02,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x03,0x06,0x06,0x06,0x06,0x06,
+	0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,
+	0x06,0x06,0x06,0x02,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00
+};
+
+static gbv_u8 test_tiles[] =
+{
+	0x00,0x00,0x6E,0x6E,0x9F,0x93,0xBF,0x83,
+	0xBF,0x83,0x7E,0x46,0x3C,0x2C,0x18,0x18,
+	0x3C,0x3C,0x7E,0x7E,0xDB,0xDB,0xDB,0xDB,
+	0xFF,0xFF,0x3C,0x00,0x7E,0x42,0x66,0x66,
+	0x3C,0x3C,0x7E,0x42,0xFF,0x81,0xFF,0x81,
+	0xFF,0xFF,0x42,0x42,0x42,0x42,0x3C,0x3C,
+	0x1C,0x1C,0x3E,0x22,0x77,0x41,0x67,0x45,
+	0x67,0x45,0x7F,0x49,0x3E,0x22,0x1C,0x1C
+};
+
+static gbv_u8 glyph_data[] =
+{
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
+	0x60,0x60,0x00,0x00,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x6C,0x6C,0x6C,0x6C,0x24,0x24,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x20,0x20,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x44,0x44,0x28,0x28,
+	0x10,0x10,0x28,0x28,0x44,0x44,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x60,0x60,0x60,0x60,0x20,0x20,0x40,0x40,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x38,0x38,0x38,0x38,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
+	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x18,0x18,0x38,0x38,0x18,0x18,
+	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x46,0x46,0x06,0x06,
+	0x3C,0x3C,0x70,0x70,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x0E,0x0E,0x3C,0x3C,
+	0x0E,0x0E,0x0E,0x0E,0x7C,0x7C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x6C,0x6C,0x4C,0x4C,
+	0x4C,0x4C,0x7E,0x7E,0x0C,0x0C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
+	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x60,0x60,0x7C,0x7C,
+	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x06,0x06,0x0C,0x0C,
+	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x3C,0x3C,
+	0x4E,0x4E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
+	0x3E,0x3E,0x0E,0x0E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x60,0x60,0x60,0x60,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x78,0x78,0x8C,0x8C,0x0C,0x0C,0x38,0x38,
+	0x30,0x30,0x00,0x00,0x30,0x30,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
+	0x7E,0x7E,0x4E,0x4E,0x4E,0x4E,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x66,0x66,0x7C,0x7C,
+	0x66,0x66,0x66,0x66,0x7C,0x7C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
+	0x60,0x60,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x4E,0x4E,0x4E,0x4E,
+	0x4E,0x4E,0x4E,0x4E,0x7C,0x7C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
+	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x60,0x60,0x60,0x60,
+	0x78,0x78,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
+	0x6E,0x6E,0x66,0x66,0x3E,0x3E,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x7E,0x7E,
+	0x46,0x46,0x46,0x46,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x18,0x18,0x18,0x18,
+	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x1E,0x1E,0x0C,0x0C,0x0C,0x0C,
+	0x6C,0x6C,0x6C,0x6C,0x38,0x38,0x00,0x00,
+	0x00,0x00,0x66,0x66,0x6C,0x6C,0x78,0x78,
+	0x78,0x78,0x6C,0x6C,0x66,0x66,0x00,0x00,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
+	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x6E,0x6E,0x7E,0x7E,
+	0x56,0x56,0x46,0x46,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x66,0x66,0x76,0x76,
+	0x5E,0x5E,0x4E,0x4E,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
+	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x66,0x66,0x66,0x66,
+	0x7C,0x7C,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x62,0x62,0x62,0x62,
+	0x6A,0x6A,0x64,0x64,0x3A,0x3A,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x62,0x62,0x62,0x62,
+	0x7C,0x7C,0x68,0x68,0x66,0x66,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x60,0x60,0x3C,0x3C,
+	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x18,0x18,0x18,0x18,
+	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
+	0x46,0x46,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
+	0x46,0x46,0x2C,0x2C,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x56,0x56,
+	0x7E,0x7E,0x6E,0x6E,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x2C,0x2C,0x18,0x18,
+	0x38,0x38,0x64,0x64,0x42,0x42,0x00,0x00,
+	0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x3C,
+	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x0E,0x0E,0x1C,0x1C,
+	0x38,0x38,0x70,0x70,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
+	0x7E,0x7E,0x4E,0x4E,0x4E,0x4E,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x66,0x66,0x7C,0x7C,
+	0x66,0x66,0x66,0x66,0x7C,0x7C,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
+	0x60,0x60,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x4E,0x4E,0x4E,0x4E,
+	0x4E,0x4E,0x4E,0x4E,0x7C,0x7C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
+	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x60,0x60,0x60,0x60,
+	0x78,0x78,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
+	0x6E,0x6E,0x66,0x66,0x3E,0x3E,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x7E,0x7E,
+	0x46,0x46,0x46,0x46,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x18,0x18,0x18,0x18,
+	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x1E,0x1E,0x0C,0x0C,0x0C,0x0C,
+	0x6C,0x6C,0x6C,0x6C,0x38,0x38,0x00,0x00,
+	0x00,0x00,0x66,0x66,0x6C,0x6C,0x78,0x78,
+	0x78,0x78,0x6C,0x6C,0x66,0x66,0x00,0x00,
+	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
+	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x6E,0x6E,0x7E,0x7E,
+	0x56,0x56,0x46,0x46,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x66,0x66,0x76,0x76,
+	0x5E,0x5E,0x4E,0x4E,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
+	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x66,0x66,0x66,0x66,
+	0x7C,0x7C,0x60,0x60,0x60,0x60,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x62,0x62,0x62,0x62,
+	0x6A,0x6A,0x64,0x64,0x3A,0x3A,0x00,0x00,
+	0x00,0x00,0x7C,0x7C,0x62,0x62,0x62,0x62,
+	0x7C,0x7C,0x68,0x68,0x66,0x66,0x00,0x00,
+	0x00,0x00,0x3C,0x3C,0x60,0x60,0x3C,0x3C,
+	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x18,0x18,0x18,0x18,
+	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
+	0x46,0x46,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
+	0x46,0x46,0x2C,0x2C,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x46,0x46,0x56,0x56,
+	0x7E,0x7E,0x6E,0x6E,0x46,0x46,0x00,0x00,
+	0x00,0x00,0x46,0x46,0x2C,0x2C,0x18,0x18,
+	0x38,0x38,0x64,0x64,0x42,0x42,0x00,0x00,
+	0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x3C,
+	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
+	0x00,0x00,0x7E,0x7E,0x0E,0x0E,0x1C,0x1C,
+	0x38,0x38,0x70,0x70,0x7E,0x7E,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00
+};
+
+#endif
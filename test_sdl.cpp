@@ -1,8 +1,11 @@
 //#include "sdlgb.h"
 #include "gbv.h"
+#include "test_data.h"
 #include <SDL2/SDL.h>
 
+/* gbv writes the scaled frame, the texture is copied 1:1 */
 #define WINDOW_SCALE  3
+#define FRAME_SCALE   GBV_SCALE_3X
 #define WINDOW_WIDTH  (WINDOW_SCALE * GBV_SCREEN_WIDTH)
 #define WINDOW_HEIGHT (WINDOW_SCALE * GBV_SCREEN_HEIGHT)
 
@@ -10,391 +13,16 @@ static void load_tile(const unsigned char *src, gbv_u8 id) {
 	memcpy(gbv_get_tile(id), src, GBV_TILE_SIZE);
 }
 
+static void write_trace(const void *data, int size, void *user_data) {
+	fwrite(data, 1, size, (FILE*)user_data);
+}
+
 static void sdl_graceful_exit(const char *fmt) {
 	fprintf(stderr, fmt, SDL_GetError());
 	SDL_Quit();
 	exit(1);
 }
 
-gbv_u8 testmap[] =
-{
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x04,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
-	0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
-	0x08,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x04,0x08,0x08,0x08,0x01,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x07,0x00,0x00,0x00,0x05,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x05,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-	0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
-	0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x03,0x06,0x06,0x06,0x02,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x03,0x06,0x06,0x06,0x06,0x06,
-	0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,0x06,
-	0x06,0x06,0x06,0x02,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00
-};
-
-gbv_u8 test_tiles[] =
-{
-	0x00,0x00,0x6E,0x6E,0x9F,0x93,0xBF,0x83,
-	0xBF,0x83,0x7E,0x46,0x3C,0x2C,0x18,0x18,
-	0x3C,0x3C,0x7E,0x7E,0xDB,0xDB,0xDB,0xDB,
-	0xFF,0xFF,0x3C,0x00,0x7E,0x42,0x66,0x66,
-	0x3C,0x3C,0x7E,0x42,0xFF,0x81,0xFF,0x81,
-	0xFF,0xFF,0x42,0x42,0x42,0x42,0x3C,0x3C,
-	0x1C,0x1C,0x3E,0x22,0x77,0x41,0x67,0x45,
-	0x67,0x45,0x7F,0x49,0x3E,0x22,0x1C,0x1C
-};
-
-gbv_u8 glyph_data[] =
-{
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
-	0x60,0x60,0x00,0x00,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x6C,0x6C,0x6C,0x6C,0x24,0x24,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x20,0x20,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x44,0x44,0x28,0x28,
-	0x10,0x10,0x28,0x28,0x44,0x44,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x60,0x60,0x60,0x60,0x20,0x20,0x40,0x40,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x38,0x38,0x38,0x38,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
-	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x18,0x18,0x38,0x38,0x18,0x18,
-	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x46,0x46,0x06,0x06,
-	0x3C,0x3C,0x70,0x70,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x0E,0x0E,0x3C,0x3C,
-	0x0E,0x0E,0x0E,0x0E,0x7C,0x7C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x6C,0x6C,0x4C,0x4C,
-	0x4C,0x4C,0x7E,0x7E,0x0C,0x0C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
-	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x60,0x60,0x7C,0x7C,
-	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x06,0x06,0x0C,0x0C,
-	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x3C,0x3C,
-	0x4E,0x4E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
-	0x3E,0x3E,0x0E,0x0E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x60,0x60,0x60,0x60,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x78,0x78,0x8C,0x8C,0x0C,0x0C,0x38,0x38,
-	0x30,0x30,0x00,0x00,0x30,0x30,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
-	0x7E,0x7E,0x4E,0x4E,0x4E,0x4E,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x66,0x66,0x7C,0x7C,
-	0x66,0x66,0x66,0x66,0x7C,0x7C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
-	0x60,0x60,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x4E,0x4E,0x4E,0x4E,
-	0x4E,0x4E,0x4E,0x4E,0x7C,0x7C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
-	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x60,0x60,0x60,0x60,
-	0x78,0x78,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
-	0x6E,0x6E,0x66,0x66,0x3E,0x3E,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x7E,0x7E,
-	0x46,0x46,0x46,0x46,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x18,0x18,0x18,0x18,
-	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x1E,0x1E,0x0C,0x0C,0x0C,0x0C,
-	0x6C,0x6C,0x6C,0x6C,0x38,0x38,0x00,0x00,
-	0x00,0x00,0x66,0x66,0x6C,0x6C,0x78,0x78,
-	0x78,0x78,0x6C,0x6C,0x66,0x66,0x00,0x00,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
-	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x6E,0x6E,0x7E,0x7E,
-	0x56,0x56,0x46,0x46,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x66,0x66,0x76,0x76,
-	0x5E,0x5E,0x4E,0x4E,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
-	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x66,0x66,0x66,0x66,
-	0x7C,0x7C,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x62,0x62,0x62,0x62,
-	0x6A,0x6A,0x64,0x64,0x3A,0x3A,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x62,0x62,0x62,0x62,
-	0x7C,0x7C,0x68,0x68,0x66,0x66,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x60,0x60,0x3C,0x3C,
-	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x18,0x18,0x18,0x18,
-	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
-	0x46,0x46,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
-	0x46,0x46,0x2C,0x2C,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x56,0x56,
-	0x7E,0x7E,0x6E,0x6E,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x2C,0x2C,0x18,0x18,
-	0x38,0x38,0x64,0x64,0x42,0x42,0x00,0x00,
-	0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x3C,
-	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x0E,0x0E,0x1C,0x1C,
-	0x38,0x38,0x70,0x70,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x4E,0x4E,0x4E,0x4E,
-	0x7E,0x7E,0x4E,0x4E,0x4E,0x4E,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x66,0x66,0x7C,0x7C,
-	0x66,0x66,0x66,0x66,0x7C,0x7C,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
-	0x60,0x60,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x4E,0x4E,0x4E,0x4E,
-	0x4E,0x4E,0x4E,0x4E,0x7C,0x7C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x60,0x60,0x7C,0x7C,
-	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x60,0x60,0x60,0x60,
-	0x78,0x78,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x60,0x60,
-	0x6E,0x6E,0x66,0x66,0x3E,0x3E,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x7E,0x7E,
-	0x46,0x46,0x46,0x46,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x18,0x18,0x18,0x18,
-	0x18,0x18,0x18,0x18,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x1E,0x1E,0x0C,0x0C,0x0C,0x0C,
-	0x6C,0x6C,0x6C,0x6C,0x38,0x38,0x00,0x00,
-	0x00,0x00,0x66,0x66,0x6C,0x6C,0x78,0x78,
-	0x78,0x78,0x6C,0x6C,0x66,0x66,0x00,0x00,
-	0x00,0x00,0x60,0x60,0x60,0x60,0x60,0x60,
-	0x60,0x60,0x60,0x60,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x6E,0x6E,0x7E,0x7E,
-	0x56,0x56,0x46,0x46,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x66,0x66,0x76,0x76,
-	0x5E,0x5E,0x4E,0x4E,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x66,0x66,0x66,0x66,
-	0x66,0x66,0x66,0x66,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x66,0x66,0x66,0x66,
-	0x7C,0x7C,0x60,0x60,0x60,0x60,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x62,0x62,0x62,0x62,
-	0x6A,0x6A,0x64,0x64,0x3A,0x3A,0x00,0x00,
-	0x00,0x00,0x7C,0x7C,0x62,0x62,0x62,0x62,
-	0x7C,0x7C,0x68,0x68,0x66,0x66,0x00,0x00,
-	0x00,0x00,0x3C,0x3C,0x60,0x60,0x3C,0x3C,
-	0x0E,0x0E,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x18,0x18,0x18,0x18,
-	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
-	0x46,0x46,0x4E,0x4E,0x3C,0x3C,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x46,0x46,
-	0x46,0x46,0x2C,0x2C,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x46,0x46,0x56,0x56,
-	0x7E,0x7E,0x6E,0x6E,0x46,0x46,0x00,0x00,
-	0x00,0x00,0x46,0x46,0x2C,0x2C,0x18,0x18,
-	0x38,0x38,0x64,0x64,0x42,0x42,0x00,0x00,
-	0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x3C,
-	0x18,0x18,0x18,0x18,0x18,0x18,0x00,0x00,
-	0x00,0x00,0x7E,0x7E,0x0E,0x0E,0x1C,0x1C,
-	0x38,0x38,0x70,0x70,0x7E,0x7E,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00
-};
-
 const gbv_u8 test_tile0 = 20;
 const gbv_u8 test_tile1 = 21;
 const gbv_u8 test_tile2 = 22;
@@ -493,7 +121,7 @@ int main(int argc, char *argv[]) {
 	if (!renderer) {
 		sdl_graceful_exit("Error creating renderer: %s\n");
 	}
-	SDL_Texture * framebuffer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, GBV_SCREEN_WIDTH, GBV_SCREEN_HEIGHT);
+	SDL_Texture * framebuffer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
 	if (!framebuffer) {
 		sdl_graceful_exit("Error creating framebuffer: %s\n");
 	}
@@ -503,7 +131,7 @@ int main(int argc, char *argv[]) {
 	fprintf(stdout, "Initialized SDL version %d.%d.%d\n", sdl_ver.major, sdl_ver.minor, sdl_ver.patch);
 	fprintf(stdout, "  platform:         %s\n", SDL_GetPlatform());
 	fprintf(stdout, "  video driver:     %s\n", SDL_GetCurrentVideoDriver());
-	fprintf(stdout, "  framebuffer size: %dx%d\n", GBV_SCREEN_WIDTH, GBV_SCREEN_HEIGHT);
+	fprintf(stdout, "  framebuffer size: %dx%d\n", WINDOW_WIDTH, WINDOW_HEIGHT);
 	fprintf(stdout, "  window size:      %dx%d\n", WINDOW_WIDTH, WINDOW_HEIGHT);
 	fprintf(stdout, "  scale:            %dx\n", WINDOW_SCALE);
 
@@ -514,9 +142,22 @@ int main(int argc, char *argv[]) {
 
 	/* gb setup */
 	unsigned char gbmem[GBV_HW_MEMORY_SIZE] = {};
-	unsigned char video_mem[GBV_SCREEN_SIZE] = {};
 	gbv_init(&gbmem);
 
+	/* keep the palette indices of the last frame, frames where only palettes change are recolored */
+	static unsigned char retained_frame[GBV_RETAINED_FRAME_SIZE];
+	gbv_set_retained_frame(retained_frame);
+
+	/* test_sdl -record <file> records a trace that gbv_bench can replay */
+	FILE *trace_file = 0;
+	if (argc > 2 && !strcmp(argv[1], "-record")) {
+		trace_file = fopen(argv[2], "wb");
+		if (!trace_file) {
+			fprintf(stderr, "Error opening trace file %s\n", argv[2]);
+			exit(1);
+		}
+	}
+
 	/* enable lcd */
 	gbv_lcdc_set(GBV_LCDC_CTRL);
 
@@ -545,25 +186,6 @@ int main(int argc, char *argv[]) {
 		map_data0[y * GBV_BG_TILES_X + x] = i + 1;
 	}
 
-	unsigned char bg_tiles[] =
-	{
-		0xFF,0xFF,0x01,0xFF,0x01,0xFF,0xF9,0x07,
-		0xF9,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
-		0x19,0x07,0x19,0x07,0x19,0x07,0xF9,0x07,
-		0xF9,0x07,0x01,0xFF,0x01,0xFF,0xFF,0xFF,
-		0x98,0xE0,0x98,0xE0,0x98,0xE0,0x9F,0xE0,
-		0x9F,0xE0,0x80,0xFF,0x80,0xFF,0xFF,0xFF,
-		0xFF,0xFF,0x80,0xFF,0x80,0xFF,0x9F,0xE0,
-		0x9F,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
-		0x19,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
-		0x19,0x07,0x19,0x07,0x19,0x07,0x19,0x07,
-		0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-		0xFF,0x00,0x00,0xFF,0x00,0xFF,0xFF,0xFF,
-		0x98,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
-		0x98,0xE0,0x98,0xE0,0x98,0xE0,0x98,0xE0,
-		0xFF,0xFF,0x00,0xFF,0x00,0xFF,0xFF,0x00,
-		0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00
-	};
 	for (int i = 0; i < 16; i++) {
 		load_tile(bg_tiles + i * 16, i + 1);
 	}
@@ -657,8 +279,14 @@ int main(int argc, char *argv[]) {
 	draw_display(&d);
 
 	gbv_u8 sprite_x = 8, sprite_y = 16;
+	static unsigned char trace_memory[GBV_TRACE_MEMORY_SIZE];
+	if (trace_file) {
+		gbv_start_trace(trace_memory, write_trace, trace_file);
+	}
+
 	/* main loop */
 	int running = 1;
+	int scene_changed = 1;
 	while (running) {
 		SDL_Event evt;
 		while (SDL_PollEvent(&evt)) {
@@ -667,6 +295,7 @@ int main(int argc, char *argv[]) {
 				running = false;
 				break;
 			case SDL_KEYDOWN:
+				scene_changed = 1;
 				switch (evt.key.keysym.sym) {
 				case SDLK_UP:
 					sprite_y--;
@@ -706,24 +335,18 @@ int main(int argc, char *argv[]) {
 		sprites[3].attr = flags;
 		gbv_transfer_oam_data(sprites);
 
-		/* render gbv state to 8bit per pixel buffer */
-		gbv_palette palette = { 0xFF, 0xAA, 0x55, 0x00 };
-		gbv_render(video_mem, GBV_RENDER_MODE_GRAYSCALE_8, &palette);
-
-		/* transfer data to framebuffer */
-		void *video_mem_rgba;
-		int video_mem_pitch;
-		SDL_LockTexture(framebuffer, 0, &video_mem_rgba, &video_mem_pitch);
-		for (int y = 0; y < GBV_SCREEN_HEIGHT; y++) {
-			for (int x = 0; x < GBV_SCREEN_WIDTH; x++) {
-				unsigned char *src_px = video_mem + GBV_SCREEN_WIDTH * y + x;
-				unsigned char *dst_px = (unsigned char*)video_mem_rgba + y * video_mem_pitch + 4 * x;
-				dst_px[0] = 0xFF;
-				dst_px[1] = src_px[0];
-				dst_px[2] = src_px[0];
-				dst_px[3] = src_px[0];
-			}
+		/* render gbv state straight into the framebuffer */
+		gbv_palette32 palette = { 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFF000000 };
+		gbv_render_target target = {};
+		target.mode = GBV_RENDER_MODE_RGBA8888;
+		target.palette32 = &palette;
+		target.scale = FRAME_SCALE;
+		SDL_LockTexture(framebuffer, 0, &target.buffer, &target.pitch);
+		/* only obp0 changed since the last frame unless a key was pressed, traces record every frame */
+		if (scene_changed || trace_file || !gbv_recolor(&target)) {
+			gbv_render_to(&target);
 		}
+		scene_changed = 0;
 		SDL_UnlockTexture(framebuffer);
 
 		/* transfer framebuffer to screen */
@@ -734,6 +357,10 @@ int main(int argc, char *argv[]) {
 		/* delay 20 ms */
 		SDL_Delay(20);
 	}
+	if (trace_file) {
+		gbv_stop_trace();
+		fclose(trace_file);
+	}
 	SDL_Quit();
 
 	return 0;